@@ -1,9 +1,45 @@
 #ifndef BIG_INTEGER_HPP
 #define BIG_INTEGER_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GH_BIG_INTEGER_MMAP 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define GH_BIG_INTEGER_X86 1
+#define GH_TARGET(features) __attribute__((target(features)))
+#endif
+
 using namespace std;
 
 /**
@@ -17,658 +53,5410 @@ namespace gh {
  */
 const auto BASE = 10;
 
+/**
+ * @brief The most digits an operand may have to take the single word fast
+ * paths; 10^9 - 1 fits in an unsigned.
+ */
+const auto SMALL_DIGITS = 9;
+
 /**
  * @brief Enumeration representing the sign of a BigInteger.
  */
 enum class Sign { POSITIVE, NEGATIVE };
 
 /**
- * @class BigInteger
- * @brief A class to represent arbitrary-precision integers.
+ * @class BudgetExceeded
+ * @brief Exception thrown when an operation runs out of its ComputeBudget.
+ *
+ * The operation that throws leaves its target unchanged.
  */
-class BigInteger {
-  private:
-    Sign m_sign;
-    vector<char> m_data;
+class BudgetExceeded : public std::runtime_error {
+  public:
+    BudgetExceeded() : std::runtime_error("budget exceeded") {}
+};
 
+/**
+ * @class ComputeBudget
+ * @brief A cooperative, thread-local limit on wall time and digit operations.
+ *
+ * While a ComputeBudget is alive, every BigInteger kernel running on the same
+ * thread charges its work to it and throws BudgetExceeded once the deadline
+ * has passed or the digit operation limit is used up. Budgets nest; work is
+ * charged to every enclosing budget on the thread, so the tightest one wins.
+ *
+ * example:
+ *
+ *     try {
+ *         ComputeBudget budget(std::chrono::milliseconds(50));
+ *         x *= y;
+ *     } catch (const BudgetExceeded &) {
+ *         // x still holds its old value
+ *     }
+ */
+class ComputeBudget {
   private:
+    bool m_has_deadline;
+    std::chrono::steady_clock::time_point m_deadline;
+    bool m_has_limit;
+    unsigned long long m_limit;
+    unsigned long long m_used;
+    bool m_exceeded;
+    ComputeBudget *m_prev;
+
     /**
-     * @brief Parse a character array into a vector of digits.
-     * @param str The character array to parse.
-     * @return A vector of digits representing the parsed integer.
+     * @brief Get the slot holding the active budget of the calling thread.
+     * @return A reference to the thread-local slot.
      */
-    vector<char> parse(const char *str);
+    static ComputeBudget *&slot();
 
+  public:
     /**
-     * @brief Get the count of digits in the BigInteger.
-     * @return The number of digits.
+     * @brief Constructor that limits wall time only.
+     * @param wall The time allowed from now on.
      */
-    int count() const;
+    explicit ComputeBudget(std::chrono::nanoseconds wall);
 
     /**
-     * @brief Add a digit to the end of the BigInteger.
-     * @param val The digit to add.
+     * @brief Constructor that limits digit operations only.
+     * @param digit_ops The number of digit operations allowed.
      */
-    void push_digit(const int &val);
+    explicit ComputeBudget(unsigned long long digit_ops);
 
     /**
-     * @brief Change a digit at a specific position in the BigInteger.
-     * @param pos The position to change.
-     * @param val The new value for the digit.
+     * @brief Constructor that limits both wall time and digit operations.
+     * @param wall The time allowed from now on.
+     * @param digit_ops The number of digit operations allowed.
      */
-    void change_digit(const int &pos, const int &val);
+    ComputeBudget(std::chrono::nanoseconds wall, unsigned long long digit_ops);
+
+    ComputeBudget(const ComputeBudget &) = delete;
+    ComputeBudget &operator=(const ComputeBudget &) = delete;
 
     /**
-     * @brief Get a digit at a specific position in the BigInteger.
-     * @param pos The position to retrieve.
-     * @return The digit at the specified position.
+     * @brief Destructor, reinstates the previously active budget.
      */
-    int get_digit(const int &pos) const;
+    ~ComputeBudget();
 
     /**
-     * @brief Convert the BigInteger to a string representation.
-     * @return The string representation of the BigInteger.
+     * @brief Get the budget active on the calling thread.
+     * @return The active budget, or nullptr when there is none.
      */
-    string to_string() const;
+    static ComputeBudget *current();
 
     /**
-     * @brief Normalize the BigInteger, removing leading zeros.
+     * @brief Charge digit operations to this budget and every one enclosing
+     * it, throwing without charging any if one of them is exhausted.
+     * @param digit_ops The number of digit operations about to be performed.
      */
-    void normalize();
+    void charge(unsigned long long digit_ops);
 
     /**
-     * @brief Check if the BigInteger is equal to another BigInteger.
-     * @param rhs The other BigInteger to compare.
-     * @return True if they are equal, false otherwise.
+     * @brief Get the number of digit operations charged so far.
+     * @return The digit operations used.
      */
-    bool equal(const BigInteger &rhs) const;
+    unsigned long long used() const;
 
     /**
-     * @brief Check if the BigInteger is less than another BigInteger.
-     * @param rhs The other BigInteger to compare.
-     * @return True if the current BigInteger is less than rhs, false otherwise.
+     * @brief Check whether the budget has already been exceeded.
+     * @return True if a charge has failed, false otherwise.
      */
-    bool less_than(const BigInteger &rhs) const;
+    bool exceeded() const;
+};
+
+/**
+ * @brief Function used to allocate digit storage.
+ */
+using alloc_func = void *(*)(size_t size);
+
+/**
+ * @brief Function used to resize digit storage. Kept for compatibility with
+ * GMP style hook sets; digit vectors allocate fresh buffers instead.
+ */
+using realloc_func = void *(*)(void *ptr, size_t old_size, size_t new_size);
+
+/**
+ * @brief Function used to release digit storage.
+ */
+using free_func = void (*)(void *ptr, size_t size);
+
+/**
+ * @brief Set the functions every BigInteger uses for its digit storage.
+ *
+ * Values allocated before the call keep releasing their storage through the
+ * functions they were allocated with. Passing nullptr for a function restores
+ * its malloc based default.
+ *
+ * @param alloc The allocation function.
+ * @param realloc The reallocation function.
+ * @param free The release function.
+ */
+void set_memory_functions(alloc_func alloc, realloc_func realloc,
+                          free_func free);
 
+/**
+ * @brief Get the functions installed by set_memory_functions.
+ * @param alloc Receives the allocation function, if not nullptr.
+ * @param realloc Receives the reallocation function, if not nullptr.
+ * @param free Receives the release function, if not nullptr.
+ */
+void get_memory_functions(alloc_func *alloc, realloc_func *realloc,
+                          free_func *free);
+
+/**
+ * @brief Route the digit storage of new BigIntegers to a memory resource.
+ *
+ * The resource must outlive every BigInteger allocated from it. Passing
+ * nullptr goes back to the functions installed by set_memory_functions.
+ *
+ * @param resource The resource to allocate from.
+ */
+void set_memory_resource(std::pmr::memory_resource *resource);
+
+/**
+ * @brief Get the memory resource new BigIntegers allocate from.
+ * @return The active memory resource.
+ */
+std::pmr::memory_resource *get_memory_resource();
+
+/**
+ * @class ScratchStack
+ * @brief A per-thread bump pointer stack for the temporaries of the kernels.
+ *
+ * Buffers are carved off the top of the stack and given back in bulk when the
+ * Marker taken before them goes out of scope. The stack grows geometrically
+ * in chunks that are kept for reuse, so a kernel called in a loop allocates
+ * only on its first iteration. Chunks come from the functions installed with
+ * set_memory_functions.
+ */
+class ScratchStack {
+  public:
     /**
-     * @brief Check if the BigInteger is positive.
-     * @return True if the BigInteger is positive, false otherwise.
+     * @class Marker
+     * @brief Releases everything allocated after its construction when it is
+     * destroyed.
      */
-    bool is_positive() const;
+    class Marker {
+      private:
+        ScratchStack &m_stack;
+        size_t m_chunk;
+        size_t m_top;
+
+      public:
+        /**
+         * @brief Constructor that marks the top of the calling thread's stack.
+         */
+        Marker();
+
+        /**
+         * @brief Constructor that marks the top of the given stack.
+         * @param stack The stack to mark.
+         */
+        explicit Marker(ScratchStack &stack);
+
+        Marker(const Marker &) = delete;
+        Marker &operator=(const Marker &) = delete;
+
+        /**
+         * @brief Destructor, pops the stack back to the mark.
+         */
+        ~Marker();
+    };
+
+  private:
+    struct Chunk {
+        char *data;
+        size_t size;
+        std::pmr::memory_resource *resource;
+    };
+
+    vector<Chunk> m_chunks;
+    size_t m_chunk;
+    size_t m_top;
 
     /**
-     * @brief Check if the BigInteger is negative.
-     * @return True if the BigInteger is negative, false otherwise.
+     * @brief Reserve raw bytes on top of the stack.
+     * @param bytes The number of bytes.
+     * @param align The alignment of the returned pointer.
+     * @return The reserved bytes.
      */
-    bool is_negative() const;
+    void *allocate(size_t bytes, size_t align);
 
   public:
     /**
-     * @brief Default constructor for BigInteger.
+     * @brief The size of the first chunk in bytes.
      */
-    BigInteger();
+    static const size_t INITIAL_SIZE = 4096;
+
+    ScratchStack();
+    ScratchStack(const ScratchStack &) = delete;
+    ScratchStack &operator=(const ScratchStack &) = delete;
+    ~ScratchStack();
 
     /**
-     * @brief Constructor that initializes a BigInteger with an integer value.
-     * @param num The integer value to initialize the BigInteger.
+     * @brief Get the stack of the calling thread.
+     * @return The thread-local stack.
      */
-    BigInteger(int num);
+    static ScratchStack &local();
 
     /**
-     * @brief Constructor that initializes a BigInteger from a character array.
-     * @param num The character array representing the integer value.
+     * @brief Reserve uninitialized storage for trivially copyable values.
+     * @param n The number of values.
+     * @return The storage, valid until the enclosing Marker is destroyed.
      */
-    BigInteger(const char *num);
+    template <typename T> T *alloc(size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "scratch values are never constructed or destroyed");
+        return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    }
 
     /**
-     * @brief Constructor that initializes a BigInteger from a string.
-     * @param num The string representing the integer value.
+     * @brief Get the total size of the chunks held by the stack.
+     * @return The capacity in bytes.
      */
-    BigInteger(const string &num);
+    size_t capacity() const;
+};
+
+/**
+ * @class ArenaScope
+ * @brief Makes every BigInteger created on the calling thread allocate from a
+ * monotonic arena until the scope ends.
+ *
+ * The arena is released in one shot when the scope is destroyed, so all
+ * BigIntegers created inside it must be gone by then. Copy and move
+ * assignment into a value created outside keep that value's storage, but a
+ * value moved out of the scope (for example returned by value) still points
+ * into the arena and has to be promoted first:
+ *
+ *     BigInteger result;
+ *     {
+ *         ArenaScope scope;
+ *         BigInteger x = compute();
+ *         result = x; // copied into result's own storage
+ *     }
+ *
+ * Scopes nest; the innermost one is active.
+ */
+class ArenaScope {
+  private:
+    std::pmr::monotonic_buffer_resource m_arena;
+    std::pmr::memory_resource *m_prev;
 
     /**
-     * @brief Copy constructor for BigInteger.
-     * @param rhs The BigInteger to copy from.
+     * @brief Get the slot holding the active arena of the calling thread.
+     * @return A reference to the thread-local slot.
      */
-    BigInteger(const BigInteger &rhs);
+    static std::pmr::memory_resource *&slot();
 
+  public:
     /**
-     * @brief Move constructor for BigInteger.
-     * @param rhs The BigInteger to move from.
+     * @brief Constructor that opens an arena on the calling thread.
+     * @param initial_size The size in bytes of the arena's first block.
      */
-    BigInteger(BigInteger &&rhs);
+    explicit ArenaScope(size_t initial_size = 4096);
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
 
     /**
-     * @brief Copy assignment operator for BigInteger.
-     * @param rhs The BigInteger to copy from.
-     * @return A reference to the assigned BigInteger.
+     * @brief Destructor, releases the arena and reinstates the previous one.
      */
-    BigInteger &operator=(const BigInteger &rhs);
+    ~ArenaScope();
 
     /**
-     * @brief Move assignment operator for BigInteger.
-     * @param rhs The BigInteger to move from.
-     * @return A reference to the assigned BigInteger.
+     * @brief Get the arena active on the calling thread.
+     * @return The active arena, or nullptr when there is none.
      */
-    BigInteger &operator=(BigInteger &&rhs);
+    static std::pmr::memory_resource *current();
+};
+
+class BigInteger;
+class SharedBigInteger;
+
+namespace detail {
 
+/**
+ * @brief The Mersenne prime 2^61 - 1 that value fingerprints are taken
+ * modulo.
+ */
+const uint64_t FINGERPRINT_PRIME = (1ULL << 61) - 1;
+
+/**
+ * @brief Add two residues modulo FINGERPRINT_PRIME.
+ * @param a The left-hand side residue.
+ * @param b The right-hand side residue.
+ * @return (a + b) mod FINGERPRINT_PRIME.
+ */
+uint64_t add_mod61(uint64_t a, uint64_t b);
+
+/**
+ * @brief Negate a residue modulo FINGERPRINT_PRIME.
+ * @param a The residue.
+ * @return -a mod FINGERPRINT_PRIME.
+ */
+uint64_t neg_mod61(uint64_t a);
+
+/**
+ * @brief Multiply two residues modulo FINGERPRINT_PRIME.
+ * @param a The left-hand side residue.
+ * @param b The right-hand side residue.
+ * @return (a * b) mod FINGERPRINT_PRIME.
+ */
+uint64_t mul_mod61(uint64_t a, uint64_t b);
+
+/**
+ * @brief A carry-propagating kernel over two runs of n digits, stored as
+ * characters least significant first: r = a + b + carry for add_n and
+ * r = a - b - carry for sub_n. r may be a or b, but must not overlap them
+ * otherwise.
+ * @param r The n result digits.
+ * @param a The left-hand side digits.
+ * @param b The right-hand side digits.
+ * @param n The number of digits.
+ * @param carry The carry or borrow into the lowest digit, 0 or 1.
+ * @return The carry or borrow out of the highest digit, 0 or 1.
+ */
+using digits_n_func = int (*)(char *r, const char *a, const char *b, int n,
+                              int carry);
+
+/**
+ * @brief A multiply-accumulate kernel: cols[i] += a[i] * b for i < n. The
+ * caller keeps the columns from overflowing, see LIMB_ROWS.
+ * @param cols The n column sums.
+ * @param a The limbs to multiply, each below LIMB_BASE.
+ * @param n The number of limbs.
+ * @param b The limb to multiply by, below LIMB_BASE.
+ */
+using addmul_1_func = void (*)(uint64_t *cols, const uint32_t *a, int n,
+                               uint32_t b);
+
+/**
+ * @brief A reversing copy: r[i] = a[n - 1 - i]. Since digits are stored
+ * least significant first, this converts between the stored digits and
+ * decimal text in both directions.
+ * @param r The n output characters, not overlapping a.
+ * @param a The n input characters.
+ * @param n The number of characters.
+ */
+using reverse_func = void (*)(char *r, const char *a, int n);
+
+/**
+ * @brief One tier of digit kernels, such as "avx2".
+ */
+struct Kernels {
+    const char *tier;
+    const char *report;
+    digits_n_func add_n;
+    digits_n_func sub_n;
+    addmul_1_func addmul_1;
+    reverse_func reverse;
+};
+
+/**
+ * @brief Get the kernels in use. The first call picks the best tier the CPU
+ * supports, or the one named by the GH_BIGINT_KERNEL environment variable.
+ * Every tier gives the same digits as the portable one.
+ * @return The active kernels.
+ */
+const Kernels &kernels();
+
+/**
+ * @brief Get the slot holding the active kernels.
+ * @return The slot, initialized on the first call.
+ */
+std::atomic<const Kernels *> &kernel_slot();
+
+/**
+ * @brief Find the best tier at or below the requested one that this CPU
+ * supports.
+ * @param tier The requested tier name, or nullptr for the best one.
+ * @return The kernels of that tier, or nullptr if the name is unknown.
+ */
+const Kernels *find_kernels(const char *tier);
+
+/**
+ * @brief Resolve the carries of a block of digits by carry-lookahead.
+ * @param generate Bit i is set if digit i carries out by itself.
+ * @param propagate Bit i is set if digit i carries out only when it has a
+ * carry in.
+ * @param carry The carry into digit 0.
+ * @param width The number of digits in the block, at most 64.
+ * @param carry_out Receives the carry out of the block.
+ * @return Bit i is set if digit i has a carry in.
+ */
+uint64_t lookahead(uint64_t generate, uint64_t propagate, int carry,
+                   int width, int &carry_out);
+
+/**
+ * @brief The base of the limbs products are computed in.
+ */
+const uint32_t LIMB_BASE = 1000000000;
+
+/**
+ * @brief The number of digits in a limb.
+ */
+const int LIMB_DIGITS = 9;
+
+/**
+ * @brief How many limb products a column sum takes before it may overflow:
+ * 18 * (10^9 - 1)^2 plus a pushed-up carry stays below 2^64.
+ */
+const int LIMB_ROWS = 18;
+
+/**
+ * @brief Get the number of limbs needed for a number of digits.
+ * @param count The number of digits.
+ * @return The number of limbs.
+ */
+int limb_count(int count);
+
+/**
+ * @brief Pack digits into limbs, nine digits each.
+ * @param digits The digits, least significant first.
+ * @param count The number of digits.
+ * @param limbs Receives limb_count(count) limbs, least significant first.
+ * @return The number of limbs written.
+ */
+int to_limbs(const char *digits, int count, uint32_t *limbs);
+
+/**
+ * @brief Push the carries of column sums up, leaving every column below
+ * LIMB_BASE. The carry out of the last column must be zero.
+ * @param cols The column sums.
+ * @param size The number of columns.
+ */
+void carry_limbs(uint64_t *cols, int size);
+
+/**
+ * @brief Unpack carried column sums into digits, nine per limb.
+ * @param cols The limbs, each below LIMB_BASE, least significant first.
+ * @param size The number of limbs.
+ * @param digits Receives size * LIMB_DIGITS digits, least significant first.
+ */
+void from_limbs(const uint64_t *cols, int size, char *digits);
+
+/**
+ * @brief The limbs below the requested ones that mulhi still computes, so
+ * that the products it skips can only change its result in rare cases it
+ * detects.
+ */
+const int MULHI_GUARD_LIMBS = 3;
+
+int add_n_scalar(char *r, const char *a, const char *b, int n, int carry);
+int sub_n_scalar(char *r, const char *a, const char *b, int n, int carry);
+void addmul_1_scalar(uint64_t *cols, const uint32_t *a, int n, uint32_t b);
+void reverse_scalar(char *r, const char *a, int n);
+
+#ifdef GH_BIG_INTEGER_X86
+GH_TARGET("sse2")
+int add_n_sse2(char *r, const char *a, const char *b, int n, int carry);
+GH_TARGET("sse2")
+int sub_n_sse2(char *r, const char *a, const char *b, int n, int carry);
+GH_TARGET("avx2")
+int add_n_avx2(char *r, const char *a, const char *b, int n, int carry);
+GH_TARGET("avx2")
+int sub_n_avx2(char *r, const char *a, const char *b, int n, int carry);
+GH_TARGET("avx512f,avx512bw")
+int add_n_avx512(char *r, const char *a, const char *b, int n, int carry);
+GH_TARGET("avx512f,avx512bw")
+int sub_n_avx512(char *r, const char *a, const char *b, int n, int carry);
+GH_TARGET("avx2")
+void addmul_1_avx2(uint64_t *cols, const uint32_t *a, int n, uint32_t b);
+GH_TARGET("avx512f")
+void addmul_1_avx512(uint64_t *cols, const uint32_t *a, int n, uint32_t b);
+GH_TARGET("sse2") void reverse_sse2(char *r, const char *a, int n);
+GH_TARGET("avx2") void reverse_avx2(char *r, const char *a, int n);
+GH_TARGET("avx512f,avx512bw")
+void reverse_avx512(char *r, const char *a, int n);
+#endif
+
+} // namespace detail
+
+/**
+ * @brief The instruction set extensions the CPU and the OS support.
+ */
+struct CpuFeatures {
+    bool sse2;
+    bool ssse3;
+    bool sse42;
+    bool avx2;
+    bool avx512f;
+    bool avx512bw;
+    bool bmi2;
+    bool adx;
+};
+
+/**
+ * @brief Get the features of the CPU the program runs on, detected once.
+ * @return The features; all false on other architectures.
+ */
+const CpuFeatures &cpu_features();
+
+/**
+ * @brief Describe the kernels in use, for logs and bug reports.
+ * @return The tier and the implementation bound to each kernel, such as
+ * "avx2: add_n=avx2 sub_n=avx2 addmul_1=avx2".
+ */
+string active_kernels();
+
+/**
+ * @brief Switch every kernel to a tier, like setting GH_BIGINT_KERNEL before
+ * the first operation. A tier the CPU lacks falls back to the best one it
+ * has below it. Operations already running keep their kernels.
+ * @param tier One of "scalar", "sse2", "avx2" or "avx512".
+ * @return The tier now in use.
+ * @throws std::invalid_argument If the tier is unknown.
+ */
+string set_kernel_tier(const string &tier);
+
+/**
+ * @class BigIntegerView
+ * @brief A non-owning, read-only view of a sign and a digit array.
+ *
+ * The digits are characters '0' to '9', least significant first and without
+ * leading zeros, the same layout BigInteger stores; zero is the empty view.
+ * They may live anywhere (a BigInteger, a SharedBigInteger, an mmap'd file or
+ * a network buffer) as long as they outlive the view. BigInteger and
+ * SharedBigInteger convert to views implicitly, so every function taking a
+ * view accepts them as well.
+ */
+class BigIntegerView {
+  private:
+    Sign m_sign;
+    const char *m_data;
+    int m_size;
+
+  public:
     /**
-     * @brief Destructor for BigInteger.
+     * @brief Default constructor, views zero.
      */
-    ~BigInteger();
+    BigIntegerView();
 
     /**
-     * @brief Addition operator to add two BigIntegers.
-     * @param rhs The BigInteger to add.
-     * @return The result of the addition.
+     * @brief Constructor that views external digits.
+     * @param sign The sign of the value.
+     * @param digits The digits, least significant first.
+     * @param count The number of digits.
      */
-    BigInteger operator+(const BigInteger &rhs) const;
+    BigIntegerView(Sign sign, const char *digits, int count);
 
     /**
-     * @brief In-place addition operator to add another BigInteger.
-     * @param rhs The BigInteger to add.
-     * @return A reference to the modified BigInteger.
+     * @brief Constructor that views the digits of a BigInteger.
+     * @param value The BigInteger to view.
      */
-    BigInteger &operator+=(const BigInteger &rhs);
+    BigIntegerView(const BigInteger &value);
 
     /**
-     * @brief Subtraction operator to subtract another BigInteger.
-     * @param rhs The BigInteger to subtract.
-     * @return The result of the subtraction.
+     * @brief Constructor that views the digits of a SharedBigInteger.
+     * @param value The SharedBigInteger to view.
      */
-    BigInteger operator-(const BigInteger &rhs) const;
+    BigIntegerView(const SharedBigInteger &value);
 
     /**
-     * @brief In-place subtraction operator to subtract another BigInteger.
-     * @param rhs The BigInteger to subtract.
-     * @return A reference to the modified BigInteger.
+     * @brief Get the sign.
+     * @return The sign of the value.
      */
-    BigInteger &operator-=(const BigInteger &rhs);
+    Sign sign() const;
 
     /**
-     * @brief Multiplication operator to multiply two BigIntegers.
-     * @param rhs The BigInteger to multiply.
-     * @return The result of the multiplication.
+     * @brief Get the digits.
+     * @return The digits as characters, least significant first.
      */
-    BigInteger operator*(const BigInteger &rhs) const;
+    const char *data() const;
 
     /**
-     * @brief In-place multiplication operator to multiply by another
-     * BigInteger.
-     * @param rhs The BigInteger to multiply by.
-     * @return A reference to the modified BigInteger.
+     * @brief Get the count of digits.
+     * @return The number of digits.
      */
-    BigInteger &operator*=(const BigInteger &rhs);
+    int count() const;
 
     /**
-     * @brief Multiplication operator to multiply by an integer.
-     * @param num The integer to multiply by.
-     * @return The result of the multiplication.
+     * @brief Get a digit at a specific position.
+     * @param pos The position to retrieve.
+     * @return The digit at the specified position, 0 past the end.
      */
-    BigInteger operator*(const int &num) const;
+    int get_digit(const int &pos) const;
 
     /**
-     * @brief In-place multiplication operator to multiply by an integer.
-     * @param num The integer to multiply by.
-     * @return A reference to the modified BigInteger.
+     * @brief Convert the viewed value to a string representation.
+     * @return The string representation of the value.
      */
-    BigInteger &operator*=(const int &num);
+    string to_string() const;
 
     /**
-     * @brief Equality operator to check if two BigIntegers are equal.
-     * @param lhs The left-hand side BigInteger.
-     * @param rhs The right-hand side BigInteger.
-     * @return True if they are equal, false otherwise.
+     * @brief Hash the viewed value. Equal values hash equally, whether they
+     * are viewed from a BigInteger, a SharedBigInteger or external memory.
+     * @return The hash of the value.
      */
-    friend bool operator==(const BigInteger &lhs, const BigInteger &rhs);
+    size_t hash() const;
 
     /**
-     * @brief Inequality operator to check if two BigIntegers are not equal.
-     * @param lhs The left-hand side BigInteger.
-     * @param rhs The right-hand side BigInteger.
-     * @return True if they are not equal, false otherwise.
+     * @brief Hash the digits of a value, ignoring its sign.
+     * @param digits The digits, least significant first.
+     * @param count The number of digits.
+     * @return The hash of the digits, never 0.
      */
-    friend bool operator!=(const BigInteger &lhs, const BigInteger &rhs);
+    static uint64_t hash_digits(const char *digits, int count);
 
     /**
-     * @brief Less than operator to check if one BigInteger is less than
-     * another.
-     * @param lhs The left-hand side BigInteger.
-     * @param rhs The right-hand side BigInteger.
-     * @return True if lhs is less than rhs, false otherwise.
+     * @brief Combine a digit hash with a sign.
+     * @param digits_hash The result of hash_digits.
+     * @param sign The sign of the value.
+     * @return The hash of the value.
      */
+    static size_t hash_value(uint64_t digits_hash, Sign sign);
 
-    friend bool operator<(const BigInteger &lhs, const BigInteger &rhs);
+    /**
+     * @brief Reduce the magnitude modulo detail::FINGERPRINT_PRIME.
+     * @return The residue of |value|, in O(n).
+     */
+    uint64_t residue() const;
 
     /**
-     * @brief Less than or equal to operator to check if one BigInteger is less
-     * than or equal to another.
-     * @param lhs The left-hand side BigInteger.
-     * @param rhs The right-hand side BigInteger.
-     * @return True if lhs is less than or equal to rhs, false otherwise.
+     * @brief Compare the magnitudes of two values, ignoring signs.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @return Negative, zero or positive as |lhs| is less than, equal to or
+     * greater than |rhs|.
      */
-    friend bool operator<=(const BigInteger &lhs, const BigInteger &rhs);
+    static int compare_magnitude(BigIntegerView lhs, BigIntegerView rhs);
 
     /**
-     * @brief Greater than operator to check if one BigInteger is greater than
-     * another.
-     * @param lhs The left-hand side BigInteger.
-     * @param rhs The right-hand side BigInteger.
-     * @return True if lhs is greater than rhs, false otherwise.
+     * @brief Compare two values.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @return Negative, zero or positive as lhs is less than, equal to or
+     * greater than rhs.
      */
-    friend bool operator>(const BigInteger &lhs, const BigInteger &rhs);
+    static int compare(BigIntegerView lhs, BigIntegerView rhs);
+};
+
+/**
+ * @brief Equality operator for views.
+ * @param lhs The left-hand side value.
+ * @param rhs The right-hand side value.
+ * @return True if they are equal, false otherwise.
+ */
+bool operator==(BigIntegerView lhs, BigIntegerView rhs);
+
+/**
+ * @brief Inequality operator for views.
+ * @param lhs The left-hand side value.
+ * @param rhs The right-hand side value.
+ * @return True if they are not equal, false otherwise.
+ */
+bool operator!=(BigIntegerView lhs, BigIntegerView rhs);
+
+/**
+ * @brief Less than operator for views.
+ * @param lhs The left-hand side value.
+ * @param rhs The right-hand side value.
+ * @return True if lhs is less than rhs, false otherwise.
+ */
+bool operator<(BigIntegerView lhs, BigIntegerView rhs);
+
+/**
+ * @brief Less than or equal to operator for views.
+ * @param lhs The left-hand side value.
+ * @param rhs The right-hand side value.
+ * @return True if lhs is less than or equal to rhs, false otherwise.
+ */
+bool operator<=(BigIntegerView lhs, BigIntegerView rhs);
+
+/**
+ * @brief Greater than operator for views.
+ * @param lhs The left-hand side value.
+ * @param rhs The right-hand side value.
+ * @return True if lhs is greater than rhs, false otherwise.
+ */
+bool operator>(BigIntegerView lhs, BigIntegerView rhs);
+
+/**
+ * @brief Greater than or equal to operator for views.
+ * @param lhs The left-hand side value.
+ * @param rhs The right-hand side value.
+ * @return True if lhs is greater than or equal to rhs, false otherwise.
+ */
+bool operator>=(BigIntegerView lhs, BigIntegerView rhs);
+
+/**
+ * @brief Overloaded output stream operator to print a view.
+ * @param os The output stream.
+ * @param rhs The view to output.
+ * @return The output stream.
+ */
+ostream &operator<<(ostream &os, BigIntegerView rhs);
+
+/**
+ * @brief Add two decimal integers given as text, without building
+ * BigIntegers. The text is an optional '-' followed by digits; leading zeros
+ * are allowed.
+ * @param lhs The left-hand side text.
+ * @param rhs The right-hand side text.
+ * @param out Receives the sum in canonical form; its capacity is reused.
+ * @throws std::invalid_argument If either text is not a decimal integer.
+ */
+void add_decimal_strings(std::string_view lhs, std::string_view rhs,
+                         string &out);
 
+/**
+ * @brief Compare two decimal integers given as text, without building
+ * BigIntegers. The text is an optional '-' followed by digits; leading zeros
+ * are allowed.
+ * @param lhs The left-hand side text.
+ * @param rhs The right-hand side text.
+ * @return Negative, zero or positive as lhs is less than, equal to or
+ * greater than rhs.
+ * @throws std::invalid_argument If either text is not a decimal integer.
+ */
+int compare_decimal_strings(std::string_view lhs, std::string_view rhs);
+
+namespace detail {
+
+/**
+ * @brief Split decimal text into its sign and significant digits.
+ * @param text An optional '-' followed by digits.
+ * @param negative Receives whether the value is below zero.
+ * @return The digits without leading zeros, most significant first; empty
+ * for zero.
+ * @throws std::invalid_argument If the text is not a decimal integer.
+ */
+std::string_view split_decimal(std::string_view text, bool &negative);
+
+} // namespace detail
+
+/**
+ * @class BigInteger
+ * @brief A class to represent arbitrary-precision integers.
+ */
+class BigInteger {
+  public:
     /**
-     * @brief Greater than or equal to operator to check if one BigInteger is
-     * greater than or equal to another.
-     * @param lhs The left-hand side BigInteger.
-     * @param rhs The right-hand side BigInteger.
-     * @return True if lhs is greater than or equal to rhs, false otherwise.
+     * @brief The allocator used for the digit storage.
      */
-    friend bool operator>=(const BigInteger &lhs, const BigInteger &rhs);
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+  private:
+    Sign m_sign;
+    std::pmr::vector<char> m_data;
+
+    // set while the digits live in a buffer shared with other copies, see
+    // share(); m_data is empty then
+    std::shared_ptr<std::pmr::vector<char>> m_shared;
 
+    // hash of the digits, 0 until hash() is first called after a write
+    mutable std::atomic<uint64_t> m_hash{0};
+
+    // residue of the magnitude modulo detail::FINGERPRINT_PRIME; writes drop
+    // it and, once enable_fingerprint() was called, the arithmetic operators
+    // put it back
+    uint64_t m_residue = 0;
+    bool m_residue_valid = false;
+    bool m_fingerprinted = false;
+
+  private:
     /**
-     * @brief Overloaded output stream operator to print the BigInteger.
-     * @param os The output stream.
-     * @param rhs The BigInteger to output.
-     * @return The output stream.
+     * @brief Parse a character array into the sign and digits.
+     * @param str The character array to parse.
      */
-    friend ostream &operator<<(ostream &os, const BigInteger &rhs);
+    void parse(const char *str);
 
     /**
-     * @brief Overloaded input stream operator to read a BigInteger from an
-     * input stream.
-     * @param is The input stream.
-     * @param rhs The BigInteger to read into.
-     * @return The input stream.
+     * @brief Get the digits, wherever they are stored.
+     * @return The digits, least significant first.
      */
-    friend istream &operator>>(istream &is, const BigInteger &rhs);
-};
+    const std::pmr::vector<char> &digits() const;
 
-/*************************************************
- * implementation
- *
- *
- *
- */
+    /**
+     * @brief Give this BigInteger a private copy of a shared buffer.
+     */
+    void unshare();
+
+    /**
+     * @brief Take the digits of another value, sharing its buffer only when
+     * that buffer comes from the same memory resource as this value's
+     * storage; a buffer from an arena may not live as long as this value.
+     * @param rhs The value to take the digits of.
+     */
+    void assign_digits(const BigInteger &rhs);
+
+    /**
+     * @brief Turn a value whose digits were moved out into a canonical zero,
+     * with its cached hash and residue to match.
+     */
+    void clear_moved_from();
+
+    /**
+     * @brief Prepare the digits for a write: unshare them and drop the cached
+     * hash and residue.
+     */
+    void before_write();
+
+    /**
+     * @brief Get the residue of the signed value, for updating it across an
+     * operation.
+     * @return The value modulo detail::FINGERPRINT_PRIME.
+     */
+    uint64_t signed_residue() const;
+
+    /**
+     * @brief Store the residue computed for the result of an operation, if
+     * the fingerprint is enabled.
+     * @param residue The result modulo detail::FINGERPRINT_PRIME.
+     */
+    void set_signed_residue(uint64_t residue);
+
+    /**
+     * @brief Get the count of digits in the BigInteger.
+     * @return The number of digits.
+     */
+    int count() const;
+
+    /**
+     * @brief Add a digit to the end of the BigInteger.
+     * @param val The digit to add.
+     */
+    void push_digit(const int &val);
+
+    /**
+     * @brief Change a digit at a specific position in the BigInteger.
+     * @param pos The position to change.
+     * @param val The new value for the digit.
+     */
+    void change_digit(const int &pos, const int &val);
+
+    /**
+     * @brief Get a digit at a specific position in the BigInteger.
+     * @param pos The position to retrieve.
+     * @return The digit at the specified position.
+     */
+    int get_digit(const int &pos) const;
+
+    /**
+     * @brief Convert the BigInteger to a string representation.
+     * @return The string representation of the BigInteger.
+     */
+    string to_string() const;
+
+    /**
+     * @brief Normalize the BigInteger, removing leading zeros.
+     */
+    void normalize();
+
+    /**
+     * @brief Check if the BigInteger is equal to another BigInteger.
+     * @param rhs The other BigInteger to compare.
+     * @return True if they are equal, false otherwise.
+     */
+    bool equal(const BigInteger &rhs) const;
+
+    /**
+     * @brief Check if the BigInteger is less than another BigInteger.
+     * @param rhs The other BigInteger to compare.
+     * @return True if the current BigInteger is less than rhs, false otherwise.
+     */
+    bool less_than(const BigInteger &rhs) const;
+
+    /**
+     * @brief Check if the BigInteger is positive.
+     * @return True if the BigInteger is positive, false otherwise.
+     */
+    bool is_positive() const;
+
+    /**
+     * @brief Check if the BigInteger is negative.
+     * @return True if the BigInteger is negative, false otherwise.
+     */
+    bool is_negative() const;
+
+    /**
+     * @brief Compare the magnitudes of two BigIntegers, ignoring signs.
+     * @param rhs The other BigInteger to compare.
+     * @return Negative, zero or positive as |this| is less than, equal to or
+     * greater than |rhs|.
+     */
+    int compare_magnitude(BigIntegerView rhs) const;
+
+    /**
+     * @brief Add the magnitude of rhs to the magnitude of this BigInteger.
+     * @param rhs The BigInteger to add.
+     */
+    void add_magnitude(BigIntegerView rhs);
+
+    /**
+     * @brief Subtract the magnitude of rhs from the magnitude of this
+     * BigInteger. Requires |this| >= |rhs|.
+     * @param rhs The BigInteger to subtract.
+     */
+    void sub_magnitude(BigIntegerView rhs);
+
+    /**
+     * @brief Add rhs to this BigInteger as if rhs had the given sign.
+     * @param rhs The BigInteger to add.
+     * @param rhs_sign The sign to use for rhs.
+     */
+    void add_signed(BigIntegerView rhs, Sign rhs_sign);
+
+    /**
+     * @brief Make sure a view does not point into the digits of this
+     * BigInteger, copying it onto the scratch stack if it does.
+     * @param rhs The view to check.
+     * @return A view that stays valid while this BigInteger is mutated, until
+     * the caller's ScratchStack::Marker is destroyed.
+     */
+    BigIntegerView unaliased(BigIntegerView rhs) const;
+
+    /**
+     * @brief Subtract the magnitude of this BigInteger from the magnitude of
+     * rhs, storing the result in this BigInteger. Requires |rhs| > |this|.
+     * @param rhs The BigInteger to subtract from.
+     */
+    void rsub_magnitude(BigIntegerView rhs);
+
+    /**
+     * @brief Add a machine word to the magnitude, touching digits only until
+     * the carry resolves.
+     * @param num The word to add.
+     */
+    void add_1(unsigned num);
+
+    /**
+     * @brief Subtract a machine word from the magnitude, touching digits only
+     * until the borrow resolves. Requires |this| >= num.
+     * @param num The word to subtract.
+     */
+    void sub_1(unsigned num);
+
+    /**
+     * @brief Multiply the magnitude by a machine word.
+     * @param num The word to multiply by.
+     */
+    void mul_1(unsigned num);
+
+    /**
+     * @brief Divide the magnitude by a machine word.
+     * @param num The nonzero word to divide by.
+     * @return The remainder of the magnitude.
+     */
+    unsigned divrem_1(unsigned num);
+
+    /**
+     * @brief Add a signed machine word, keeping the fingerprint.
+     * @param num The magnitude of the word.
+     * @param sign The sign of the word.
+     */
+    void add_signed_1(unsigned num, Sign sign);
+
+    /**
+     * @brief Multiply by a nonzero signed machine word, keeping the
+     * fingerprint.
+     * @param num The magnitude of the word.
+     * @param sign The sign of the word.
+     */
+    void mul_signed_1(unsigned num, Sign sign);
+
+    /**
+     * @brief Read a magnitude of at most SMALL_DIGITS + 1 digits.
+     * @param value The value to read.
+     * @return |value| as a machine word.
+     */
+    static unsigned long long small_magnitude(BigIntegerView value);
+
+    /**
+     * @brief Get the allocator for a BigInteger created now on this thread.
+     * @return An allocator for the active ArenaScope, or for
+     * get_memory_resource when there is none.
+     */
+    static allocator_type new_allocator();
+
+    /**
+     * @brief Build a pool constant: a shared copy of the value, allocated
+     * outside any arena, with its fingerprint computed.
+     * @param value The value to copy.
+     * @return The constant, never deleted.
+     */
+    static const BigInteger *make_constant(BigIntegerView value);
+
+    /**
+     * @brief Compute a window of the limb columns of |lhs| * |rhs|, skipping
+     * the partial products that fall outside it. Scratch memory is taken
+     * from the ScratchStack, so the caller holds a Marker.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @param from The lowest column to compute.
+     * @param to One past the highest column to compute.
+     * @param cols Receives to - from limbs, each below detail::LIMB_BASE;
+     * the carry out of the highest one is dropped.
+     */
+    static void mul_window(BigIntegerView lhs, BigIntegerView rhs, int from,
+                           int to, uint64_t *cols);
+
+    /**
+     * @brief Charge digit operations to the active ComputeBudget, if any.
+     * @param digit_ops The number of digit operations about to be performed.
+     */
+    static void charge_budget(unsigned long long digit_ops);
+
+  public:
+    /**
+     * @brief Default constructor for BigInteger.
+     */
+    BigInteger();
+
+    /**
+     * @brief Constructor that initializes a BigInteger with an integer value.
+     * @param num The integer value to initialize the BigInteger.
+     */
+    BigInteger(int num);
+
+    /**
+     * @brief Constructor that initializes a BigInteger from a character array.
+     * @param num The character array representing the integer value.
+     */
+    BigInteger(const char *num);
+
+    /**
+     * @brief Constructor that initializes a BigInteger from a string.
+     * @param num The string representing the integer value.
+     */
+    BigInteger(const string &num);
+
+    /**
+     * @brief Constructor that copies the value of a view.
+     * @param view The view to copy from.
+     */
+    explicit BigInteger(BigIntegerView view);
 
-BigInteger::BigInteger() : m_sign(Sign::POSITIVE), m_data{} {}
+    /**
+     * @brief Copy constructor for BigInteger.
+     * @param rhs The BigInteger to copy from.
+     */
+    BigInteger(const BigInteger &rhs);
+
+    /**
+     * @brief Copy constructor that places the copy in the given allocator.
+     * @param rhs The BigInteger to copy from.
+     * @param alloc The allocator for the digit storage of the copy.
+     */
+    BigInteger(const BigInteger &rhs, const allocator_type &alloc);
+
+    /**
+     * @brief Move constructor for BigInteger.
+     * @param rhs The BigInteger to move from.
+     */
+    BigInteger(BigInteger &&rhs);
+
+    /**
+     * @brief Copy assignment operator for BigInteger.
+     * @param rhs The BigInteger to copy from.
+     * @return A reference to the assigned BigInteger.
+     */
+    BigInteger &operator=(const BigInteger &rhs);
+
+    /**
+     * @brief Move assignment operator for BigInteger.
+     * @param rhs The BigInteger to move from.
+     * @return A reference to the assigned BigInteger.
+     */
+    BigInteger &operator=(BigInteger &&rhs);
+
+    /**
+     * @brief Assignment operator copying the value of a view, reusing the
+     * existing capacity.
+     * @param view The view to copy from.
+     * @return A reference to the assigned BigInteger.
+     */
+    BigInteger &operator=(BigIntegerView view);
+
+    /**
+     * @brief Destructor for BigInteger.
+     */
+    ~BigInteger();
+
+    /**
+     * @brief Get the allocator of the digit storage.
+     * @return The allocator in use.
+     */
+    allocator_type get_allocator() const;
+
+    /**
+     * @brief Make room for at least the given number of digits, so that
+     * results up to that size never reallocate.
+     * @param digits The number of digits to make room for.
+     */
+    void reserve(size_t digits);
+
+    /**
+     * @brief Get the number of digits that fit without reallocating.
+     * @return The capacity in digits.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Release the capacity not needed by the current value.
+     */
+    void shrink_to_fit();
+
+    /**
+     * @brief Hash the value. The digit hash is cached until the next
+     * mutation, so values used repeatedly as keys are hashed once.
+     * @return The hash of the value, equal to the hash of its view.
+     */
+    size_t hash() const;
+
+    /**
+     * @brief Switch to copy-on-write storage. Copies made from now on share
+     * the digit buffer through an atomic reference count and take a private
+     * copy only when they are mutated while the buffer is still shared.
+     * Shared values may be read and copied from many threads at once. A
+     * copy whose storage comes from another memory resource, such as a value
+     * outside the ArenaScope the buffer was allocated in, copies the digits.
+     * @return A reference to the shared BigInteger.
+     */
+    BigInteger &share();
+
+    /**
+     * @brief Check whether the digits live in a copy-on-write buffer.
+     * @return True if the storage is shared, false otherwise.
+     */
+    bool is_shared() const;
+
+    /**
+     * @brief Move the digit storage out of an ArenaScope onto the resource
+     * returned by get_memory_resource, so the value outlives the scope.
+     * @return A reference to the promoted BigInteger.
+     */
+    BigInteger &promote();
+
+    /**
+     * @brief Keep a fingerprint of the value: its residue modulo the prime
+     * 2^61 - 1. It is computed once here and then updated in O(1) by +=, -=
+     * and *= (besides the O(n) reduction of the other operand, which the
+     * operation reads anyway), so unequal fingerprinted values compare
+     * unequal without a digit scan. Copies inherit the fingerprint.
+     */
+    void enable_fingerprint();
+
+    /**
+     * @brief Check whether an up to date fingerprint is stored.
+     * @return True if fingerprint() is O(1), false otherwise.
+     */
+    bool has_fingerprint() const;
+
+    /**
+     * @brief Get the fingerprint, computing it if none is stored.
+     * @return The magnitude modulo 2^61 - 1.
+     */
+    uint64_t fingerprint() const;
+
+    /**
+     * @brief The smallest integer interned ahead of time.
+     */
+    static const int INTERN_MIN = -128;
+
+    /**
+     * @brief The largest integer interned ahead of time.
+     */
+    static const int INTERN_MAX = 1024;
+
+    /**
+     * @brief Get the canonical zero.
+     * @return A shared, immutable zero; copying it never allocates.
+     */
+    static const BigInteger &zero();
+
+    /**
+     * @brief Get the canonical one.
+     * @return A shared, immutable one; copying it never allocates.
+     */
+    static const BigInteger &one();
+
+    /**
+     * @brief Get the interned instance of an integer. Values from INTERN_MIN
+     * to INTERN_MAX are built on first use of the pool; any other value is
+     * registered as by intern(BigIntegerView).
+     * @param value The value to look up.
+     * @return A shared, immutable instance that lives until the program
+     * exits. Copies share its digits until they are written.
+     */
+    static const BigInteger &intern(int value);
+
+    /**
+     * @brief Register a constant, such as a modulus or a power of ten, in the
+     * interning pool. Registering an equal value again returns the first
+     * instance. Safe to call from any thread.
+     * @param value The value to intern.
+     * @return A shared, immutable instance that lives until the program
+     * exits. Copies share its digits until they are written.
+     */
+    static const BigInteger &intern(BigIntegerView value);
+
+    /**
+     * @brief Addition operator to add two BigIntegers.
+     * @param rhs The BigInteger to add.
+     * @return The result of the addition.
+     */
+    BigInteger operator+(const BigInteger &rhs) const;
+
+    /**
+     * @brief In-place addition operator to add another BigInteger.
+     * @param rhs The BigInteger to add.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator+=(const BigInteger &rhs);
+
+    /**
+     * @brief Addition operator taking a view.
+     * @param rhs The value to add.
+     * @return The result of the addition.
+     */
+    BigInteger operator+(BigIntegerView rhs) const;
+
+    /**
+     * @brief In-place addition operator taking a view.
+     * @param rhs The value to add.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator+=(BigIntegerView rhs);
+
+    /**
+     * @brief Subtraction operator to subtract another BigInteger.
+     * @param rhs The BigInteger to subtract.
+     * @return The result of the subtraction.
+     */
+    BigInteger operator-(const BigInteger &rhs) const;
+
+    /**
+     * @brief In-place subtraction operator to subtract another BigInteger.
+     * @param rhs The BigInteger to subtract.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator-=(const BigInteger &rhs);
+
+    /**
+     * @brief Subtraction operator taking a view.
+     * @param rhs The value to subtract.
+     * @return The result of the subtraction.
+     */
+    BigInteger operator-(BigIntegerView rhs) const;
+
+    /**
+     * @brief In-place subtraction operator taking a view.
+     * @param rhs The value to subtract.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator-=(BigIntegerView rhs);
+
+    /**
+     * @brief Multiplication operator to multiply two BigIntegers.
+     * @param rhs The BigInteger to multiply.
+     * @return The result of the multiplication.
+     */
+    BigInteger operator*(const BigInteger &rhs) const;
+
+    /**
+     * @brief In-place multiplication operator to multiply by another
+     * BigInteger.
+     * @param rhs The BigInteger to multiply by.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator*=(const BigInteger &rhs);
+
+    /**
+     * @brief Multiplication operator taking a view.
+     * @param rhs The value to multiply by.
+     * @return The result of the multiplication.
+     */
+    BigInteger operator*(BigIntegerView rhs) const;
+
+    /**
+     * @brief In-place multiplication operator taking a view.
+     * @param rhs The value to multiply by.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator*=(BigIntegerView rhs);
+
+    /**
+     * @brief Multiplication operator to multiply by an integer.
+     * @param num The integer to multiply by.
+     * @return The result of the multiplication.
+     */
+    BigInteger operator*(const int &num) const;
+
+    /**
+     * @brief In-place multiplication operator to multiply by an integer.
+     * @param num The integer to multiply by.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator*=(const int &num);
+
+    /**
+     * @brief Addition operator to add an integer.
+     * @param num The integer to add.
+     * @return The result of the addition.
+     */
+    BigInteger operator+(const int &num) const;
+
+    /**
+     * @brief In-place addition operator to add an integer. Only the digits up
+     * to where the carry or borrow resolves are touched.
+     * @param num The integer to add.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator+=(const int &num);
+
+    /**
+     * @brief Subtraction operator to subtract an integer.
+     * @param num The integer to subtract.
+     * @return The result of the subtraction.
+     */
+    BigInteger operator-(const int &num) const;
+
+    /**
+     * @brief In-place subtraction operator to subtract an integer. Only the
+     * digits up to where the carry or borrow resolves are touched.
+     * @param num The integer to subtract.
+     * @return A reference to the modified BigInteger.
+     */
+    BigInteger &operator-=(const int &num);
+
+    /**
+     * @brief Division operator to divide by an integer, truncating toward
+     * zero.
+     * @param num The nonzero integer to divide by.
+     * @return The quotient.
+     * @throws std::domain_error If num is zero.
+     */
+    BigInteger operator/(const int &num) const;
+
+    /**
+     * @brief In-place division operator to divide by an integer, truncating
+     * toward zero.
+     * @param num The nonzero integer to divide by.
+     * @return A reference to the modified BigInteger.
+     * @throws std::domain_error If num is zero.
+     */
+    BigInteger &operator/=(const int &num);
+
+    /**
+     * @brief Remainder operator for an integer divisor. The remainder takes
+     * the sign of this BigInteger, as for built-in integers.
+     * @param num The nonzero integer to divide by.
+     * @return The remainder.
+     * @throws std::domain_error If num is zero.
+     */
+    int operator%(const int &num) const;
+
+    /**
+     * @brief Prefix increment operator. Only the digits up to where the carry
+     * resolves are touched, so repeated increments are amortized O(1).
+     * @return A reference to the incremented BigInteger.
+     */
+    BigInteger &operator++();
+
+    /**
+     * @brief Postfix increment operator.
+     * @return The value before the increment.
+     */
+    BigInteger operator++(int);
+
+    /**
+     * @brief Prefix decrement operator. Only the digits up to where the
+     * borrow resolves are touched, so repeated decrements are amortized O(1).
+     * @return A reference to the decremented BigInteger.
+     */
+    BigInteger &operator--();
+
+    /**
+     * @brief Postfix decrement operator.
+     * @return The value before the decrement.
+     */
+    BigInteger operator--(int);
+
+    /**
+     * @brief Multiply by 10^k by shifting the digits, in O(n + k).
+     * @param k The power of ten, at least 0.
+     * @return A reference to the modified BigInteger.
+     * @throws std::invalid_argument If k is negative.
+     */
+    BigInteger &mul_pow10(int k);
+
+    /**
+     * @brief Divide by 10^k, truncating toward zero, by dropping the k lowest
+     * digits.
+     * @param k The power of ten, at least 0.
+     * @return A reference to the modified BigInteger.
+     * @throws std::invalid_argument If k is negative.
+     */
+    BigInteger &div_pow10(int k);
+
+    /**
+     * @brief Divide by 10^k, truncating toward zero, and keep the remainder.
+     * The remainder takes the sign of the dividend, as with operator%.
+     * @param k The power of ten, at least 0.
+     * @param remainder Receives the k lowest digits, normalized.
+     * @return A reference to the modified BigInteger.
+     * @throws std::invalid_argument If k is negative.
+     */
+    BigInteger &divrem_pow10(int k, BigInteger &remainder);
+
+    /**
+     * @brief Compute the low digits of a product, skipping the partial
+     * products that cannot reach them.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @param n The number of digits to keep, at least 0.
+     * @return |lhs * rhs| mod 10^n, with the sign of the product.
+     * @throws std::invalid_argument If n is negative.
+     */
+    static BigInteger mullo(BigIntegerView lhs, BigIntegerView rhs, int n);
+
+    /**
+     * @brief Compute the high digits of a product, skipping most of the
+     * partial products below them. The result is exact: when the skipped
+     * products could carry into it, the full product is taken instead.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @param n The number of low digits to drop, at least 0.
+     * @return lhs * rhs / 10^n, truncated toward zero.
+     * @throws std::invalid_argument If n is negative.
+     */
+    static BigInteger mulhi(BigIntegerView lhs, BigIntegerView rhs, int n);
+
+    /**
+     * @brief Compute the middle product: digits from..to of a product, from
+     * only the partial products whose columns land there. For a 2n-digit
+     * lhs and n-digit rhs the middle n digits cost about n^2, not 2n^2,
+     * which is what a Newton step needs.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @param from The lowest digit to keep, at least 0.
+     * @param to One past the highest digit to keep, at least from.
+     * @return The kept digits, with the sign of the product. The carry from
+     * the skipped low columns is not added, so modulo 10^(to - from) the
+     * result falls short of |lhs * rhs| / 10^from by at most 10^18.
+     * @throws std::invalid_argument If from is negative or to below from.
+     */
+    static BigInteger mulmid(BigIntegerView lhs, BigIntegerView rhs, int from,
+                             int to);
+
+    /**
+     * @brief Multiply, keeping the last k decimal digits, in O(k^2) however
+     * long the operands are.
+     * @param rhs The value to multiply by.
+     * @param k The number of digits to keep, at least 0.
+     * @return A reference to the modified BigInteger, |this * rhs| mod 10^k
+     * with the sign of the product.
+     * @throws std::invalid_argument If k is negative.
+     */
+    BigInteger &mul_mod_pow10(BigIntegerView rhs, int k);
+
+    /**
+     * @brief Multiply, keeping the low k bits. 2^k divides 10^k, so this
+     * reduces the last k digits of the product further.
+     * @param rhs The value to multiply by.
+     * @param k The number of bits to keep, at least 0.
+     * @return A reference to the modified BigInteger, |this * rhs| mod 2^k
+     * with the sign of the product.
+     * @throws std::invalid_argument If k is negative.
+     */
+    BigInteger &mul_mod_pow2(BigIntegerView rhs, int k);
+
+    /**
+     * @brief Equality operator to check if two BigIntegers are equal.
+     * @param lhs The left-hand side BigInteger.
+     * @param rhs The right-hand side BigInteger.
+     * @return True if they are equal, false otherwise.
+     */
+    friend bool operator==(const BigInteger &lhs, const BigInteger &rhs);
+
+    /**
+     * @brief Inequality operator to check if two BigIntegers are not equal.
+     * @param lhs The left-hand side BigInteger.
+     * @param rhs The right-hand side BigInteger.
+     * @return True if they are not equal, false otherwise.
+     */
+    friend bool operator!=(const BigInteger &lhs, const BigInteger &rhs);
+
+    /**
+     * @brief Less than operator to check if one BigInteger is less than
+     * another.
+     * @param lhs The left-hand side BigInteger.
+     * @param rhs The right-hand side BigInteger.
+     * @return True if lhs is less than rhs, false otherwise.
+     */
+
+    friend bool operator<(const BigInteger &lhs, const BigInteger &rhs);
+
+    /**
+     * @brief Less than or equal to operator to check if one BigInteger is less
+     * than or equal to another.
+     * @param lhs The left-hand side BigInteger.
+     * @param rhs The right-hand side BigInteger.
+     * @return True if lhs is less than or equal to rhs, false otherwise.
+     */
+    friend bool operator<=(const BigInteger &lhs, const BigInteger &rhs);
+
+    /**
+     * @brief Greater than operator to check if one BigInteger is greater than
+     * another.
+     * @param lhs The left-hand side BigInteger.
+     * @param rhs The right-hand side BigInteger.
+     * @return True if lhs is greater than rhs, false otherwise.
+     */
+    friend bool operator>(const BigInteger &lhs, const BigInteger &rhs);
+
+    /**
+     * @brief Greater than or equal to operator to check if one BigInteger is
+     * greater than or equal to another.
+     * @param lhs The left-hand side BigInteger.
+     * @param rhs The right-hand side BigInteger.
+     * @return True if lhs is greater than or equal to rhs, false otherwise.
+     */
+    friend bool operator>=(const BigInteger &lhs, const BigInteger &rhs);
+
+    /**
+     * @brief Overloaded output stream operator to print the BigInteger.
+     * @param os The output stream.
+     * @param rhs The BigInteger to output.
+     * @return The output stream.
+     */
+    friend ostream &operator<<(ostream &os, const BigInteger &rhs);
+
+    /**
+     * @brief Overloaded input stream operator to read a BigInteger from an
+     * input stream.
+     * @param is The input stream.
+     * @param rhs The BigInteger to read into.
+     * @return The input stream.
+     */
+    friend istream &operator>>(istream &is, const BigInteger &rhs);
+
+    friend class BigIntegerView;
+    friend class SharedBigInteger;
+};
+
+/**
+ * @class SharedBigInteger
+ * @brief An immutable, reference counted BigInteger for read-mostly data.
+ *
+ * The sign, the digits and an atomic reference count live in a single
+ * allocation, so copies cost one atomic increment and handles can be
+ * published to many reader threads or stored as map values. Arithmetic goes
+ * through views or to_big_integer().
+ */
+class SharedBigInteger {
+  private:
+    struct Header {
+        std::atomic<size_t> refs;
+        std::pmr::memory_resource *resource;
+        size_t size;
+        Sign sign;
+        uint64_t hash;
+    };
+
+    // nullptr for zero, which needs no storage
+    Header *m_header;
+
+    /**
+     * @brief Get the digits stored behind a header.
+     * @param header The header of the allocation.
+     * @return The digits, least significant first.
+     */
+    static const char *digits_of(const Header *header);
+
+    /**
+     * @brief Drop this handle's reference, freeing the value with the last.
+     */
+    void release();
+
+  public:
+    /**
+     * @brief Default constructor, holds zero.
+     */
+    SharedBigInteger();
+
+    /**
+     * @brief Constructor that freezes a copy of a BigInteger.
+     * @param value The value to copy.
+     */
+    explicit SharedBigInteger(const BigInteger &value);
+
+    /**
+     * @brief Copy constructor, shares the value of rhs.
+     * @param rhs The handle to share with.
+     */
+    SharedBigInteger(const SharedBigInteger &rhs);
+
+    /**
+     * @brief Move constructor for SharedBigInteger.
+     * @param rhs The handle to move from.
+     */
+    SharedBigInteger(SharedBigInteger &&rhs) noexcept;
+
+    /**
+     * @brief Copy assignment operator, shares the value of rhs.
+     * @param rhs The handle to share with.
+     * @return A reference to the assigned SharedBigInteger.
+     */
+    SharedBigInteger &operator=(const SharedBigInteger &rhs);
+
+    /**
+     * @brief Move assignment operator for SharedBigInteger.
+     * @param rhs The handle to move from.
+     * @return A reference to the assigned SharedBigInteger.
+     */
+    SharedBigInteger &operator=(SharedBigInteger &&rhs) noexcept;
+
+    /**
+     * @brief Destructor for SharedBigInteger.
+     */
+    ~SharedBigInteger();
+
+    /**
+     * @brief Get the count of digits.
+     * @return The number of digits.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Get the sign.
+     * @return The sign of the value.
+     */
+    Sign sign() const;
+
+    /**
+     * @brief Get the digits.
+     * @return The digits as characters, least significant first.
+     */
+    const char *data() const;
+
+    /**
+     * @brief Get the number of handles sharing the value.
+     * @return The reference count, 0 for zero.
+     */
+    size_t use_count() const;
+
+    /**
+     * @brief Make a mutable copy of the value.
+     * @return The value as a BigInteger.
+     */
+    BigInteger to_big_integer() const;
+
+    /**
+     * @brief Hash the value, computed once when the value was frozen.
+     * @return The hash of the value, equal to the hash of its view.
+     */
+    size_t hash() const;
+
+    /**
+     * @brief Compare two shared values.
+     * @param lhs The left-hand side value.
+     * @param rhs The right-hand side value.
+     * @return Negative, zero or positive as lhs is less than, equal to or
+     * greater than rhs.
+     */
+    static int compare(const SharedBigInteger &lhs,
+                       const SharedBigInteger &rhs);
+
+    friend bool operator==(const SharedBigInteger &lhs,
+                           const SharedBigInteger &rhs);
+    friend bool operator!=(const SharedBigInteger &lhs,
+                           const SharedBigInteger &rhs);
+    friend bool operator<(const SharedBigInteger &lhs,
+                          const SharedBigInteger &rhs);
+    friend bool operator<=(const SharedBigInteger &lhs,
+                           const SharedBigInteger &rhs);
+    friend bool operator>(const SharedBigInteger &lhs,
+                          const SharedBigInteger &rhs);
+    friend bool operator>=(const SharedBigInteger &lhs,
+                           const SharedBigInteger &rhs);
+    friend ostream &operator<<(ostream &os, const SharedBigInteger &rhs);
+};
+
+/**
+ * @class BigIntegerVector
+ * @brief A columnar container keeping the digits of all its values in one
+ * contiguous pool.
+ *
+ * Each element is an offset, a digit count and a sign into the pool, so
+ * scanning a column walks memory linearly instead of chasing one heap buffer
+ * per value. Elements are read as views, which stay valid until the column
+ * is next modified. Overwriting an element with a longer value leaves its old
+ * digits behind as garbage until compact() is called.
+ */
+class BigIntegerVector {
+  private:
+    struct Entry {
+        size_t offset;
+        int size;
+        Sign sign;
+    };
+
+    std::pmr::vector<char> m_pool;
+    std::pmr::vector<Entry> m_entries;
+    size_t m_garbage;
+
+    /**
+     * @brief Append digits to the pool, which may point into the pool itself.
+     * @param value The value whose digits to append.
+     * @return The offset of the appended digits.
+     */
+    size_t append_digits(BigIntegerView value);
+
+    /**
+     * @brief Replace every element with the result of an operation.
+     * @param op Called with a BigInteger holding the element and its index.
+     */
+    template <typename Op> void transform(Op op);
+
+  public:
+    /**
+     * @class const_iterator
+     * @brief Iterates over the elements as views.
+     */
+    class const_iterator {
+      private:
+        const BigIntegerVector *m_vector;
+        size_t m_pos;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = BigIntegerView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = BigIntegerView;
+
+        const_iterator(const BigIntegerVector *vector, size_t pos)
+            : m_vector(vector), m_pos(pos) {}
+
+        BigIntegerView operator*() const { return (*m_vector)[m_pos]; }
+
+        const_iterator &operator++() {
+            ++m_pos;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto res = *this;
+            ++m_pos;
+            return res;
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return m_pos == rhs.m_pos;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return m_pos != rhs.m_pos;
+        }
+    };
+
+    /**
+     * @brief Constructor for an empty column.
+     * @param resource The resource for the pool, get_memory_resource() if
+     * nullptr.
+     */
+    explicit BigIntegerVector(std::pmr::memory_resource *resource = nullptr);
+
+    /**
+     * @brief Get the number of elements.
+     * @return The number of elements.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Check whether the column has no elements.
+     * @return True if empty, false otherwise.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Get the number of digits held by the pool, garbage included.
+     * @return The pool size in digits.
+     */
+    size_t pool_size() const;
+
+    /**
+     * @brief Get the number of digits in the pool no element refers to.
+     * @return The garbage in digits.
+     */
+    size_t garbage() const;
+
+    /**
+     * @brief Make room for elements and digits up front.
+     * @param values The number of elements.
+     * @param digits The total number of digits.
+     */
+    void reserve(size_t values, size_t digits);
+
+    /**
+     * @brief Append a value.
+     * @param value The value to append.
+     */
+    void push_back(BigIntegerView value);
+
+    /**
+     * @brief Overwrite an element, in place when the new value is not longer.
+     * @param pos The index of the element.
+     * @param value The new value.
+     */
+    void set(size_t pos, BigIntegerView value);
+
+    /**
+     * @brief Get an element.
+     * @param pos The index of the element.
+     * @return A view of the element.
+     */
+    BigIntegerView operator[](size_t pos) const;
+
+    /**
+     * @brief Remove every element, keeping the capacity.
+     */
+    void clear();
+
+    /**
+     * @brief Rewrite the pool without garbage, in element order.
+     */
+    void compact();
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /**
+     * @brief Add a value to every element.
+     * @param rhs The value to add.
+     * @return A reference to the modified column.
+     */
+    BigIntegerVector &operator+=(BigIntegerView rhs);
+
+    /**
+     * @brief Add the elements of another column, element by element.
+     * @param rhs The column to add, of the same size.
+     * @return A reference to the modified column.
+     */
+    BigIntegerVector &operator+=(const BigIntegerVector &rhs);
+
+    /**
+     * @brief Multiply every element by a value.
+     * @param rhs The value to multiply by.
+     * @return A reference to the modified column.
+     */
+    BigIntegerVector &operator*=(BigIntegerView rhs);
+
+    /**
+     * @brief Multiply by the elements of another column, element by element.
+     * @param rhs The column to multiply by, of the same size.
+     * @return A reference to the modified column.
+     */
+    BigIntegerVector &operator*=(const BigIntegerVector &rhs);
+};
+
+namespace detail {
+
+/**
+ * @brief The fixed size header at the start of a column file.
+ */
+struct ColumnHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t block_size;
+    uint64_t blob_offset;
+    uint64_t entries_offset;
+    uint64_t blocks_offset;
+    uint64_t file_size;
+};
+
+/**
+ * @brief The location of one value in the digit blob of a column file.
+ */
+struct ColumnEntry {
+    uint64_t offset;
+    uint32_t size;
+    uint8_t sign;
+    uint8_t pad[3];
+};
+
+/**
+ * @brief The indices of the smallest and largest value of a block.
+ */
+struct ColumnBlock {
+    uint64_t min;
+    uint64_t max;
+};
+
+const char COLUMN_MAGIC[8] = {'G', 'H', 'B', 'I', 'G', 'C', 'O', 'L'};
+const uint32_t COLUMN_VERSION = 1;
+const uint32_t COLUMN_HAS_BLOCKS = 1;
+
+} // namespace detail
+
+/**
+ * @class BigIntegerColumnWriter
+ * @brief Streams values into a column file that BigIntegerColumnFile can
+ * map and query in place.
+ *
+ * The file holds a header, the digit blob, one entry (offset, count, sign)
+ * per value and optionally the indices of the smallest and largest value of
+ * every block, all in native byte order. Digits are written as they are
+ * appended; the entries, blocks and header follow on close().
+ */
+class BigIntegerColumnWriter {
+  private:
+    std::ofstream m_out;
+    uint64_t m_block_size;
+    uint64_t m_blob_size;
+    vector<detail::ColumnEntry> m_entries;
+    vector<detail::ColumnBlock> m_blocks;
+    BigInteger m_block_min;
+    BigInteger m_block_max;
+    bool m_closed;
+
+  public:
+    /**
+     * @brief Constructor that creates the file.
+     * @param path The path of the file, truncated if it exists.
+     * @param block_size The number of values per min/max block, 0 for none.
+     */
+    explicit BigIntegerColumnWriter(const string &path,
+                                    uint64_t block_size = 4096);
+
+    BigIntegerColumnWriter(const BigIntegerColumnWriter &) = delete;
+    BigIntegerColumnWriter &operator=(const BigIntegerColumnWriter &) = delete;
+
+    /**
+     * @brief Destructor, closes the file if close() was not called.
+     */
+    ~BigIntegerColumnWriter();
+
+    /**
+     * @brief Append a value.
+     * @param value The value to append.
+     */
+    void append(BigIntegerView value);
+
+    /**
+     * @brief Append every element of a column.
+     * @param values The column to append.
+     */
+    void append(const BigIntegerVector &values);
+
+    /**
+     * @brief Write the entries, blocks and header and close the file.
+     */
+    void close();
+};
+
+/**
+ * @class BigIntegerColumnFile
+ * @brief A read-only column file, memory mapped where the platform allows
+ * and read into memory otherwise. Values are returned as views into the
+ * mapping and stay valid as long as the file object.
+ */
+class BigIntegerColumnFile {
+  private:
+    const char *m_base;
+    size_t m_size;
+    vector<char> m_buffer;
+    const detail::ColumnHeader *m_header;
+    const detail::ColumnEntry *m_entries;
+    const detail::ColumnBlock *m_blocks;
+
+    /**
+     * @brief Check the header, the section bounds, every entry's digits and
+     * every block index, and locate the sections.
+     */
+    void validate();
+
+  public:
+    /**
+     * @brief Constructor that opens and maps a column file.
+     * @param path The path of the file.
+     * @throws std::runtime_error If the file cannot be read or is not a
+     * valid column file.
+     */
+    explicit BigIntegerColumnFile(const string &path);
+
+    BigIntegerColumnFile(const BigIntegerColumnFile &) = delete;
+    BigIntegerColumnFile &operator=(const BigIntegerColumnFile &) = delete;
+
+    /**
+     * @brief Destructor, unmaps the file.
+     */
+    ~BigIntegerColumnFile();
+
+    /**
+     * @brief Get the number of values.
+     * @return The number of values.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get a value.
+     * @param pos The index of the value.
+     * @return A view into the mapped file.
+     */
+    BigIntegerView operator[](size_t pos) const;
+
+    /**
+     * @brief Get the number of values per block.
+     * @return The block size, 0 if the file has no blocks.
+     */
+    size_t block_size() const;
+
+    /**
+     * @brief Get the number of blocks.
+     * @return The number of blocks.
+     */
+    size_t block_count() const;
+
+    /**
+     * @brief Get the smallest value of a block.
+     * @param block The index of the block.
+     * @return A view into the mapped file.
+     * @throws std::out_of_range If block is not below the block count.
+     */
+    BigIntegerView block_min(size_t block) const;
+
+    /**
+     * @brief Get the largest value of a block.
+     * @param block The index of the block.
+     * @return A view into the mapped file.
+     * @throws std::out_of_range If block is not below the block count.
+     */
+    BigIntegerView block_max(size_t block) const;
+
+    /**
+     * @brief Copy every value into a column.
+     * @return The values as a BigIntegerVector.
+     */
+    BigIntegerVector to_vector() const;
+};
+
+/**
+ * @class BigIntegerDeltaEncoder
+ * @brief Compresses a sequence of values, ideally sorted, as deltas between
+ * neighbours.
+ *
+ * Values are grouped in blocks. The first value of a block is stored raw
+ * (two digits per byte) and the others as zigzag varint deltas from their
+ * predecessor, falling back to raw digits when a delta has more than 18
+ * digits. A skip index of block offsets gives random access to every block.
+ */
+class BigIntegerDeltaEncoder {
+  private:
+    size_t m_block_size;
+    size_t m_count;
+    vector<uint8_t> m_body;
+    vector<uint64_t> m_blocks;
+    BigInteger m_prev;
+    BigInteger m_delta;
+
+  public:
+    /**
+     * @brief Constructor for an empty sequence.
+     * @param block_size The number of values per block.
+     */
+    explicit BigIntegerDeltaEncoder(size_t block_size = 128);
+
+    /**
+     * @brief Append a value.
+     * @param value The value to append.
+     */
+    void append(BigIntegerView value);
+
+    /**
+     * @brief Get the number of values appended.
+     * @return The number of values.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Serialize the sequence.
+     * @return The encoded bytes, readable with BigIntegerDeltaDecoder.
+     */
+    vector<uint8_t> encode() const;
+};
+
+/**
+ * @class BigIntegerDeltaDecoder
+ * @brief Reads a sequence written by BigIntegerDeltaEncoder in place. The
+ * encoded bytes must outlive the decoder.
+ */
+class BigIntegerDeltaDecoder {
+  private:
+    const uint8_t *m_data;
+    const uint8_t *m_end;
+    size_t m_count;
+    size_t m_block_size;
+    size_t m_block_count;
+    const uint8_t *m_index;
+    const uint8_t *m_body;
+
+    /**
+     * @brief Decode a block up to a value.
+     * @param block The index of the block.
+     * @param last The position inside the block to stop at.
+     * @param visit Called with every decoded value in order.
+     */
+    template <typename Visit>
+    void walk_block(size_t block, size_t last, Visit visit) const;
+
+  public:
+    /**
+     * @brief Constructor that parses the header and skip index.
+     * @param data The encoded bytes.
+     * @param size The number of encoded bytes.
+     */
+    BigIntegerDeltaDecoder(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Get the number of values.
+     * @return The number of values.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the number of blocks.
+     * @return The number of blocks.
+     */
+    size_t block_count() const;
+
+    /**
+     * @brief Decode a single value, starting from the head of its block.
+     * @param pos The index of the value.
+     * @return The value.
+     */
+    BigInteger operator[](size_t pos) const;
+
+    /**
+     * @brief Decode a block, appending its values to a column.
+     * @param block The index of the block.
+     * @param out The column to append to.
+     * @throws std::out_of_range If block is not below the block count.
+     */
+    void decode_block(size_t block, BigIntegerVector &out) const;
+
+    /**
+     * @brief Decode every value.
+     * @return The values as a column.
+     */
+    BigIntegerVector decode() const;
+};
+
+namespace detail {
+
+/**
+ * @brief What sort_bigints sorts: a view of one element and its position.
+ */
+struct SortKey {
+    const char *digits;
+    int count;
+    bool negative;
+    size_t index;
+};
+
+/**
+ * @brief Sort keys into ascending value order.
+ * @param keys The keys to sort.
+ */
+void sort_keys(vector<SortKey> &keys);
+
+} // namespace detail
+
+/**
+ * @brief Sort BigIntegers (or anything convertible to a view) ascending.
+ *
+ * The values are first grouped by sign and digit count, which orders them
+ * without looking at a single digit, and every group of equal length is then
+ * MSD radix sorted on its digits from the top. Large buckets are shared by
+ * up to one thread per core. Only keys move while sorting; each element is
+ * then moved twice, into a buffer in sorted order and back into the range.
+ *
+ * @param first The beginning of the range.
+ * @param last The end of the range.
+ */
+template <typename RandomIt> void sort_bigints(RandomIt first, RandomIt last) {
+    const size_t n = last - first;
+
+    vector<detail::SortKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        const BigIntegerView value = first[i];
+        keys[i] = detail::SortKey{value.data(), value.count(),
+                                  value.sign() == Sign::NEGATIVE, i};
+    }
+
+    detail::sort_keys(keys);
+
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    vector<value_type> sorted;
+    sorted.reserve(n);
+    for (const auto &key : keys)
+        sorted.push_back(std::move(first[key.index]));
+
+    std::move(sorted.begin(), sorted.end(), first);
+}
+
+/**
+ * @brief Sort a whole range of BigIntegers ascending, see sort_bigints.
+ * @param range The range to sort.
+ */
+template <typename Range> void sort_bigints(Range &range) {
+    sort_bigints(std::begin(range), std::end(range));
+}
+
+/*************************************************
+ * implementation
+ *
+ *
+ *
+ */
+
+ComputeBudget::ComputeBudget(std::chrono::nanoseconds wall)
+    : m_has_deadline(true),
+      m_deadline(std::chrono::steady_clock::now() + wall), m_has_limit(false),
+      m_limit(0), m_used(0), m_exceeded(false), m_prev(slot()) {
+    slot() = this;
+}
+
+ComputeBudget::ComputeBudget(unsigned long long digit_ops)
+    : m_has_deadline(false), m_deadline(), m_has_limit(true),
+      m_limit(digit_ops), m_used(0), m_exceeded(false), m_prev(slot()) {
+    slot() = this;
+}
+
+ComputeBudget::ComputeBudget(std::chrono::nanoseconds wall,
+                             unsigned long long digit_ops)
+    : m_has_deadline(true),
+      m_deadline(std::chrono::steady_clock::now() + wall), m_has_limit(true),
+      m_limit(digit_ops), m_used(0), m_exceeded(false), m_prev(slot()) {
+    slot() = this;
+}
+
+ComputeBudget::~ComputeBudget() { slot() = m_prev; }
+
+ComputeBudget *&ComputeBudget::slot() {
+    thread_local ComputeBudget *active = nullptr;
+    return active;
+}
+
+ComputeBudget *ComputeBudget::current() { return slot(); }
+
+void ComputeBudget::charge(unsigned long long digit_ops) {
+    // every enclosing budget is checked before any is charged, so a helper
+    // opening its own budget cannot escape its caller's
+    const auto now = std::chrono::steady_clock::now();
+    for (auto *budget = this; budget; budget = budget->m_prev) {
+        if (budget->m_has_limit &&
+            digit_ops > budget->m_limit - budget->m_used)
+            budget->m_exceeded = true;
+        else if (budget->m_has_deadline && now > budget->m_deadline)
+            budget->m_exceeded = true;
+
+        if (budget->m_exceeded)
+            throw BudgetExceeded();
+    }
+
+    for (auto *budget = this; budget; budget = budget->m_prev)
+        budget->m_used += digit_ops;
+}
+
+unsigned long long ComputeBudget::used() const { return m_used; }
+
+bool ComputeBudget::exceeded() const { return m_exceeded; }
+
+namespace detail {
+
+void *default_alloc(size_t size) { return std::malloc(size); }
+
+void *default_realloc(void *ptr, size_t, size_t new_size) {
+    return std::realloc(ptr, new_size);
+}
+
+void default_free(void *ptr, size_t) { std::free(ptr); }
+
+/**
+ * @brief A memory resource forwarding to a set of memory functions.
+ */
+class HookResource : public std::pmr::memory_resource {
+  public:
+    alloc_func m_alloc;
+    realloc_func m_realloc;
+    free_func m_free;
+
+    HookResource(alloc_func alloc, realloc_func realloc, free_func free)
+        : m_alloc(alloc), m_realloc(realloc), m_free(free) {}
+
+  private:
+    void *do_allocate(size_t bytes, size_t) override {
+        void *ptr = m_alloc(bytes ? bytes : 1);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t) override {
+        m_free(ptr, bytes ? bytes : 1);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &rhs) const
+        noexcept override {
+        return this == &rhs;
+    }
+};
+
+std::atomic<HookResource *> &hook_resource() {
+    static HookResource initial(default_alloc, default_realloc, default_free);
+    static std::atomic<HookResource *> current(&initial);
+    return current;
+}
+
+std::atomic<std::pmr::memory_resource *> &user_resource() {
+    static std::atomic<std::pmr::memory_resource *> current(nullptr);
+    return current;
+}
+
+} // namespace detail
+
+void set_memory_functions(alloc_func alloc, realloc_func realloc,
+                          free_func free) {
+    // never deleted: values allocated through the old functions still point
+    // at their resource when they are released
+    detail::hook_resource() = new detail::HookResource(
+        alloc ? alloc : detail::default_alloc,
+        realloc ? realloc : detail::default_realloc,
+        free ? free : detail::default_free);
+}
+
+void get_memory_functions(alloc_func *alloc, realloc_func *realloc,
+                          free_func *free) {
+    const auto *hooks = detail::hook_resource().load();
+    if (alloc)
+        *alloc = hooks->m_alloc;
+    if (realloc)
+        *realloc = hooks->m_realloc;
+    if (free)
+        *free = hooks->m_free;
+}
+
+void set_memory_resource(std::pmr::memory_resource *resource) {
+    detail::user_resource() = resource;
+}
+
+std::pmr::memory_resource *get_memory_resource() {
+    if (auto *resource = detail::user_resource().load())
+        return resource;
+    return detail::hook_resource().load();
+}
+
+ArenaScope::ArenaScope(size_t initial_size)
+    : m_arena(initial_size, get_memory_resource()), m_prev(slot()) {
+    slot() = &m_arena;
+}
+
+ArenaScope::~ArenaScope() { slot() = m_prev; }
+
+std::pmr::memory_resource *&ArenaScope::slot() {
+    thread_local std::pmr::memory_resource *active = nullptr;
+    return active;
+}
+
+std::pmr::memory_resource *ArenaScope::current() { return slot(); }
+
+ScratchStack::Marker::Marker() : Marker(ScratchStack::local()) {}
+
+ScratchStack::Marker::Marker(ScratchStack &stack)
+    : m_stack(stack), m_chunk(stack.m_chunk), m_top(stack.m_top) {}
+
+ScratchStack::Marker::~Marker() {
+    m_stack.m_chunk = m_chunk;
+    m_stack.m_top = m_top;
+}
+
+ScratchStack::ScratchStack() : m_chunks{}, m_chunk(0), m_top(0) {}
+
+ScratchStack::~ScratchStack() {
+    for (const auto &chunk : m_chunks)
+        chunk.resource->deallocate(chunk.data, chunk.size);
+}
+
+ScratchStack &ScratchStack::local() {
+    thread_local ScratchStack stack;
+    return stack;
+}
+
+void *ScratchStack::allocate(size_t bytes, size_t align) {
+    if (!m_chunks.empty()) {
+        const auto top = (m_top + align - 1) / align * align;
+        if (top + bytes <= m_chunks[m_chunk].size) {
+            m_top = top + bytes;
+            return m_chunks[m_chunk].data + top;
+        }
+    }
+
+    // chunks are aligned for any scalar, so a fresh one needs no padding
+    const auto next = m_chunks.empty() ? 0 : m_chunk + 1;
+    if (next < m_chunks.size() && bytes <= m_chunks[next].size) {
+        m_chunk = next;
+        m_top = bytes;
+        return m_chunks[next].data;
+    }
+
+    // the chunks above the top are free, drop them for a bigger one
+    while (m_chunks.size() > next) {
+        const auto &chunk = m_chunks.back();
+        chunk.resource->deallocate(chunk.data, chunk.size);
+        m_chunks.pop_back();
+    }
+
+    auto size = m_chunks.empty() ? INITIAL_SIZE : m_chunks.back().size * 2;
+    size = std::max(size, bytes);
+
+    auto *resource = detail::hook_resource().load();
+    auto *data = static_cast<char *>(resource->allocate(size));
+    m_chunks.push_back(Chunk{data, size, resource});
+
+    m_chunk = next;
+    m_top = bytes;
+    return data;
+}
+
+size_t ScratchStack::capacity() const {
+    size_t total = 0;
+    for (const auto &chunk : m_chunks)
+        total += chunk.size;
+    return total;
+}
+
+namespace detail {
+
+uint64_t add_mod61(uint64_t a, uint64_t b) {
+    const auto sum = a + b;
+    return sum >= FINGERPRINT_PRIME ? sum - FINGERPRINT_PRIME : sum;
+}
+
+uint64_t neg_mod61(uint64_t a) { return a ? FINGERPRINT_PRIME - a : 0; }
+
+uint64_t mul_mod61(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 uint128;
+    const auto product = uint128(a) * b;
+    const auto folded = (uint64_t(product) & FINGERPRINT_PRIME) +
+                        uint64_t(product >> 61);
+#else
+    // split into 31 and 30 bit halves; 2^61 is 1 and 2^62 is 2 modulo the
+    // prime, so the partial products fold without overflowing 64 bits
+    const uint64_t a_lo = a & 0x7fffffff, a_hi = a >> 31;
+    const uint64_t b_lo = b & 0x7fffffff, b_hi = b >> 31;
+    const uint64_t mid = a_hi * b_lo + a_lo * b_hi;
+    const uint64_t sum = 2 * a_hi * b_hi + (mid >> 30) +
+                         ((mid & 0x3fffffff) << 31) + a_lo * b_lo;
+    const auto folded = (sum & FINGERPRINT_PRIME) + (sum >> 61);
+#endif
+    return folded >= FINGERPRINT_PRIME ? folded - FINGERPRINT_PRIME : folded;
+}
+
+uint64_t lookahead(uint64_t generate, uint64_t propagate, int carry,
+                   int width, int &carry_out) {
+    // a carry enters a run of propagating digits at its low end and leaves
+    // at its high end, which is what adding the run does to a bit
+    const auto entering = (generate << 1) | uint64_t(carry);
+    const auto sum = entering + propagate;
+    carry_out = width == 64 ? int((generate >> 63) | (sum < entering))
+                            : int((sum ^ propagate) >> width & 1);
+
+    return sum ^ propagate;
+}
+
+int limb_count(int count) { return (count + LIMB_DIGITS - 1) / LIMB_DIGITS; }
+
+int to_limbs(const char *digits, int count, uint32_t *limbs) {
+    const auto size = limb_count(count);
+    for (int k = 0; k < size; ++k) {
+        const auto end = std::min(count, (k + 1) * LIMB_DIGITS);
+
+        uint32_t limb = 0;
+        for (auto i = end - 1; i >= k * LIMB_DIGITS; --i)
+            limb = limb * BASE + uint32_t(digits[i] - '0');
+        limbs[k] = limb;
+    }
+
+    return size;
+}
+
+void carry_limbs(uint64_t *cols, int size) {
+    uint64_t carry = 0;
+    for (int k = 0; k < size; ++k) {
+        carry += cols[k];
+        cols[k] = carry % LIMB_BASE;
+        carry /= LIMB_BASE;
+    }
+}
+
+void from_limbs(const uint64_t *cols, int size, char *digits) {
+    for (int k = 0; k < size; ++k) {
+        auto limb = cols[k];
+        for (int t = 0; t < LIMB_DIGITS; ++t) {
+            *digits++ = char(limb % BASE + '0');
+            limb /= BASE;
+        }
+    }
+}
+
+void addmul_1_scalar(uint64_t *cols, const uint32_t *a, int n, uint32_t b) {
+    for (int i = 0; i < n; ++i)
+        cols[i] += uint64_t(a[i]) * b;
+}
+
+void reverse_scalar(char *r, const char *a, int n) {
+    std::reverse_copy(a, a + n, r);
+}
+
+int add_n_scalar(char *r, const char *a, const char *b, int n, int carry) {
+    for (int i = 0; i < n; ++i) {
+        const auto sum = (a[i] - '0') + (b[i] - '0') + carry;
+        carry = sum >= BASE;
+        r[i] = char(sum - (carry ? BASE : 0) + '0');
+    }
+
+    return carry;
+}
+
+int sub_n_scalar(char *r, const char *a, const char *b, int n, int carry) {
+    for (int i = 0; i < n; ++i) {
+        const auto diff = (a[i] - '0') - (b[i] - '0') - carry;
+        carry = diff < 0;
+        r[i] = char(diff + (carry ? BASE : 0) + '0');
+    }
+
+    return carry;
+}
+
+#ifdef GH_BIG_INTEGER_X86
+/**
+ * @brief Spread the bits of a byte over eight bytes, bit i to byte i.
+ * @param bits The byte to spread.
+ * @return Eight bytes, each 0 or 1.
+ */
+uint64_t spread_bits(unsigned bits) {
+    static const auto table = [] {
+        std::array<uint64_t, 256> table{};
+        for (unsigned m = 0; m < 256; ++m) {
+            for (unsigned i = 0; i < 8; ++i)
+                table[m] |= uint64_t(m >> i & 1) << (8 * i);
+        }
+        return table;
+    }();
+    return table[bits & 0xff];
+}
+
+GH_TARGET("sse2")
+int add_n_sse2(char *r, const char *a, const char *b, int n, int carry) {
+    const auto zero = _mm_set1_epi8('0');
+    const auto nine = _mm_set1_epi8(9);
+    const auto ten = _mm_set1_epi8(10);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const auto lhs = _mm_loadu_si128((const __m128i *)(a + i));
+        const auto rhs = _mm_loadu_si128((const __m128i *)(b + i));
+        const auto sum =
+            _mm_add_epi8(_mm_sub_epi8(lhs, zero), _mm_sub_epi8(rhs, zero));
+
+        const auto carries = lookahead(
+            unsigned(_mm_movemask_epi8(_mm_cmpgt_epi8(sum, nine))),
+            unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(sum, nine))), carry, 16,
+            carry);
+        const auto carry_in = _mm_set_epi64x(
+            int64_t(spread_bits(unsigned(carries >> 8))),
+            int64_t(spread_bits(unsigned(carries))));
+
+        auto digit = _mm_add_epi8(sum, carry_in);
+        digit = _mm_sub_epi8(digit,
+                             _mm_and_si128(_mm_cmpgt_epi8(digit, nine), ten));
+        _mm_storeu_si128((__m128i *)(r + i), _mm_add_epi8(digit, zero));
+    }
+
+    return add_n_scalar(r + i, a + i, b + i, n - i, carry);
+}
+
+GH_TARGET("sse2")
+int sub_n_sse2(char *r, const char *a, const char *b, int n, int carry) {
+    const auto zero = _mm_set1_epi8('0');
+    const auto ten = _mm_set1_epi8(10);
+    const auto none = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const auto lhs = _mm_loadu_si128((const __m128i *)(a + i));
+        const auto rhs = _mm_loadu_si128((const __m128i *)(b + i));
+        const auto diff = _mm_sub_epi8(lhs, rhs);
+
+        const auto borrows = lookahead(
+            unsigned(_mm_movemask_epi8(_mm_cmplt_epi8(diff, none))),
+            unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(diff, none))), carry, 16,
+            carry);
+        const auto borrow_in = _mm_set_epi64x(
+            int64_t(spread_bits(unsigned(borrows >> 8))),
+            int64_t(spread_bits(unsigned(borrows))));
+
+        auto digit = _mm_sub_epi8(diff, borrow_in);
+        digit = _mm_add_epi8(digit,
+                             _mm_and_si128(_mm_cmplt_epi8(digit, none), ten));
+        _mm_storeu_si128((__m128i *)(r + i), _mm_add_epi8(digit, zero));
+    }
+
+    return sub_n_scalar(r + i, a + i, b + i, n - i, carry);
+}
+
+/**
+ * @brief Spread the bits of a mask over 32 bytes, bit i to byte i.
+ * @param bits The mask to spread.
+ * @return 32 bytes, each 0 or 1.
+ */
+GH_TARGET("avx2") __m256i spread_bits_avx2(uint32_t bits) {
+    // byte i takes mask byte i / 8, then keeps bit i % 8 of it
+    const auto select =
+        _mm256_setr_epi64x(0x0000000000000000, 0x0101010101010101,
+                           0x0202020202020202, 0x0303030303030303);
+    const auto bit = _mm256_set1_epi64x(int64_t(0x8040201008040201ULL));
+    const auto bytes =
+        _mm256_shuffle_epi8(_mm256_set1_epi32(int(bits)), select);
+
+    return _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit), bit),
+        _mm256_set1_epi8(1));
+}
+
+GH_TARGET("avx2")
+int add_n_avx2(char *r, const char *a, const char *b, int n, int carry) {
+    const auto zero = _mm256_set1_epi8('0');
+    const auto nine = _mm256_set1_epi8(9);
+    const auto ten = _mm256_set1_epi8(10);
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const auto lhs = _mm256_loadu_si256((const __m256i *)(a + i));
+        const auto rhs = _mm256_loadu_si256((const __m256i *)(b + i));
+        const auto sum = _mm256_add_epi8(_mm256_sub_epi8(lhs, zero),
+                                         _mm256_sub_epi8(rhs, zero));
+
+        const auto carries = lookahead(
+            uint32_t(_mm256_movemask_epi8(_mm256_cmpgt_epi8(sum, nine))),
+            uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(sum, nine))),
+            carry, 32, carry);
+
+        auto digit = _mm256_add_epi8(sum, spread_bits_avx2(uint32_t(carries)));
+        digit = _mm256_sub_epi8(
+            digit, _mm256_and_si256(_mm256_cmpgt_epi8(digit, nine), ten));
+        _mm256_storeu_si256((__m256i *)(r + i), _mm256_add_epi8(digit, zero));
+    }
+
+    return add_n_sse2(r + i, a + i, b + i, n - i, carry);
+}
+
+GH_TARGET("avx2")
+int sub_n_avx2(char *r, const char *a, const char *b, int n, int carry) {
+    const auto zero = _mm256_set1_epi8('0');
+    const auto ten = _mm256_set1_epi8(10);
+    const auto none = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const auto lhs = _mm256_loadu_si256((const __m256i *)(a + i));
+        const auto rhs = _mm256_loadu_si256((const __m256i *)(b + i));
+        const auto diff = _mm256_sub_epi8(lhs, rhs);
+
+        const auto borrows = lookahead(
+            uint32_t(_mm256_movemask_epi8(_mm256_cmpgt_epi8(none, diff))),
+            uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(diff, none))),
+            carry, 32, carry);
+
+        auto digit =
+            _mm256_sub_epi8(diff, spread_bits_avx2(uint32_t(borrows)));
+        digit = _mm256_add_epi8(
+            digit, _mm256_and_si256(_mm256_cmpgt_epi8(none, digit), ten));
+        _mm256_storeu_si256((__m256i *)(r + i), _mm256_add_epi8(digit, zero));
+    }
+
+    return sub_n_sse2(r + i, a + i, b + i, n - i, carry);
+}
+
+GH_TARGET("avx512f,avx512bw")
+int add_n_avx512(char *r, const char *a, const char *b, int n, int carry) {
+    const auto zero = _mm512_set1_epi8('0');
+    const auto nine = _mm512_set1_epi8(9);
+    const auto ten = _mm512_set1_epi8(10);
+
+    int i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const auto lhs = _mm512_loadu_si512(a + i);
+        const auto rhs = _mm512_loadu_si512(b + i);
+        const auto sum = _mm512_add_epi8(_mm512_sub_epi8(lhs, zero),
+                                         _mm512_sub_epi8(rhs, zero));
+
+        const auto carries = lookahead(_mm512_cmpgt_epi8_mask(sum, nine),
+                                       _mm512_cmpeq_epi8_mask(sum, nine),
+                                       carry, 64, carry);
+
+        // the masks select the digits to bump and then to wrap
+        auto digit = _mm512_mask_add_epi8(sum, carries, sum,
+                                          _mm512_set1_epi8(1));
+        digit = _mm512_mask_sub_epi8(
+            digit, _mm512_cmpgt_epi8_mask(digit, nine), digit, ten);
+        _mm512_storeu_si512(r + i, _mm512_add_epi8(digit, zero));
+    }
+
+    return add_n_avx2(r + i, a + i, b + i, n - i, carry);
+}
+
+GH_TARGET("avx512f,avx512bw")
+int sub_n_avx512(char *r, const char *a, const char *b, int n, int carry) {
+    const auto zero = _mm512_set1_epi8('0');
+    const auto ten = _mm512_set1_epi8(10);
+    const auto none = _mm512_setzero_si512();
+
+    int i = 0;
+    for (; i + 64 <= n; i += 64) {
+        const auto lhs = _mm512_loadu_si512(a + i);
+        const auto rhs = _mm512_loadu_si512(b + i);
+        const auto diff = _mm512_sub_epi8(lhs, rhs);
+
+        const auto borrows = lookahead(_mm512_cmplt_epi8_mask(diff, none),
+                                       _mm512_cmpeq_epi8_mask(diff, none),
+                                       carry, 64, carry);
+
+        auto digit = _mm512_mask_sub_epi8(diff, borrows, diff,
+                                          _mm512_set1_epi8(1));
+        digit = _mm512_mask_add_epi8(
+            digit, _mm512_cmplt_epi8_mask(digit, none), digit, ten);
+        _mm512_storeu_si512(r + i, _mm512_add_epi8(digit, zero));
+    }
+
+    return sub_n_avx2(r + i, a + i, b + i, n - i, carry);
+}
+
+GH_TARGET("avx2")
+void addmul_1_avx2(uint64_t *cols, const uint32_t *a, int n, uint32_t b) {
+    // four 32 x 32 -> 64 bit products per step
+    const auto factor = _mm256_set1_epi64x(b);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const auto limbs =
+            _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(a + i)));
+        const auto sums = _mm256_loadu_si256((const __m256i *)(cols + i));
+        _mm256_storeu_si256(
+            (__m256i *)(cols + i),
+            _mm256_add_epi64(sums, _mm256_mul_epu32(limbs, factor)));
+    }
+
+    addmul_1_scalar(cols + i, a + i, n - i, b);
+}
+
+GH_TARGET("avx512f")
+void addmul_1_avx512(uint64_t *cols, const uint32_t *a, int n, uint32_t b) {
+    const auto factor = _mm512_set1_epi64(b);
+    const __mmask8 all = 0xff;
+
+    // the zero-masking forms behave the same here, and keep GCC from warning
+    // about the undefined vectors in the plain ones
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const auto limbs = _mm512_maskz_cvtepu32_epi64(
+            all, _mm256_loadu_si256((const __m256i *)(a + i)));
+        const auto sums = _mm512_loadu_si512(cols + i);
+        _mm512_storeu_si512(
+            cols + i, _mm512_add_epi64(
+                          sums, _mm512_maskz_mul_epu32(all, limbs, factor)));
+    }
+
+    addmul_1_scalar(cols + i, a + i, n - i, b);
+}
+
+GH_TARGET("sse2") void reverse_sse2(char *r, const char *a, int n) {
+    // without pshufb: swap the bytes of each word, then reverse the words
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto x = _mm_loadu_si128((const __m128i *)(a + n - 16 - i));
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+        x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+        x = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm_storeu_si128((__m128i *)(r + i), x);
+    }
+
+    reverse_scalar(r + i, a, n - i);
+}
+
+GH_TARGET("avx2") void reverse_avx2(char *r, const char *a, int n) {
+    // vpshufb reverses each 128 bit lane, vpermq swaps the lanes
+    const auto order =
+        _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                         15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        auto x = _mm256_loadu_si256((const __m256i *)(a + n - 32 - i));
+        x = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(x, order),
+                                     _MM_SHUFFLE(1, 0, 3, 2));
+        _mm256_storeu_si256((__m256i *)(r + i), x);
+    }
+
+    reverse_sse2(r + i, a, n - i);
+}
+
+GH_TARGET("avx512f,avx512bw")
+void reverse_avx512(char *r, const char *a, int n) {
+    // bytes 15 down to 0 in every lane; the zero-masking lane shuffle keeps
+    // GCC from warning about the undefined vector in the plain one
+    const auto low = int64_t(0x08090a0b0c0d0e0fLL);
+    const auto high = int64_t(0x0001020304050607LL);
+    const auto order =
+        _mm512_set_epi64(high, low, high, low, high, low, high, low);
+
+    int i = 0;
+    for (; i + 64 <= n; i += 64) {
+        auto x = _mm512_loadu_si512(a + n - 64 - i);
+        x = _mm512_shuffle_epi8(x, order);
+        x = _mm512_maskz_shuffle_i64x2(0xff, x, x, _MM_SHUFFLE(0, 1, 2, 3));
+        _mm512_storeu_si512(r + i, x);
+    }
+
+    reverse_avx2(r + i, a, n - i);
+}
+#endif
+
+const Kernels *find_kernels(const char *tier) {
+    // best first; the portable tier is always supported
+    static const Kernels tiers[] = {
+#ifdef GH_BIG_INTEGER_X86
+        {"avx512",
+         "add_n=avx512 sub_n=avx512 addmul_1=avx512 reverse=avx512",
+         add_n_avx512, sub_n_avx512, addmul_1_avx512, reverse_avx512},
+        {"avx2", "add_n=avx2 sub_n=avx2 addmul_1=avx2 reverse=avx2",
+         add_n_avx2, sub_n_avx2, addmul_1_avx2, reverse_avx2},
+        {"sse2", "add_n=sse2 sub_n=sse2 addmul_1=scalar reverse=sse2",
+         add_n_sse2, sub_n_sse2, addmul_1_scalar, reverse_sse2},
+#endif
+        {"scalar", "add_n=scalar sub_n=scalar addmul_1=scalar reverse=scalar",
+         add_n_scalar, sub_n_scalar, addmul_1_scalar, reverse_scalar},
+    };
+
+    const auto &cpu = cpu_features();
+    auto requested = tier == nullptr;
+    for (const auto &kernels : tiers) {
+        requested = requested || std::strcmp(kernels.tier, tier) == 0;
+        if (!requested)
+            continue;
+
+        const string name = kernels.tier;
+        if ((name == "avx512" && !(cpu.avx512bw && cpu.avx2)) ||
+            (name == "avx2" && !cpu.avx2) || (name == "sse2" && !cpu.sse2))
+            continue;
+
+        return &kernels;
+    }
+
+    return nullptr;
+}
+
+std::atomic<const Kernels *> &kernel_slot() {
+    static std::atomic<const Kernels *> slot([] {
+        const Kernels *kernels = nullptr;
+        if (const auto *tier = std::getenv("GH_BIGINT_KERNEL"))
+            kernels = find_kernels(tier);
+
+        // an unknown name keeps the default rather than failing later
+        return kernels ? kernels : find_kernels(nullptr);
+    }());
+    return slot;
+}
+
+const Kernels &kernels() {
+    return *kernel_slot().load(std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+const CpuFeatures &cpu_features() {
+    static const auto features = [] {
+        CpuFeatures features{};
+#ifdef GH_BIG_INTEGER_X86
+        // __builtin_cpu_supports also checks that the OS saves the wide
+        // registers
+        __builtin_cpu_init();
+        features.sse2 = __builtin_cpu_supports("sse2");
+        features.ssse3 = __builtin_cpu_supports("ssse3");
+        features.sse42 = __builtin_cpu_supports("sse4.2");
+        features.avx2 = __builtin_cpu_supports("avx2");
+        features.avx512f = __builtin_cpu_supports("avx512f");
+        features.avx512bw = __builtin_cpu_supports("avx512bw");
+        features.bmi2 = __builtin_cpu_supports("bmi2");
+
+        // not every compiler's __builtin_cpu_supports knows ADX: CPUID leaf 7,
+        // EBX bit 19
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            features.adx = ebx >> 19 & 1;
+#endif
+        return features;
+    }();
+    return features;
+}
+
+string active_kernels() {
+    const auto &kernels = detail::kernels();
+    return string(kernels.tier) + ": " + kernels.report;
+}
+
+string set_kernel_tier(const string &tier) {
+    const auto *kernels = detail::find_kernels(tier.c_str());
+    if (!kernels)
+        throw std::invalid_argument("unknown kernel tier " + tier);
+
+    detail::kernel_slot().store(kernels, std::memory_order_relaxed);
+    return kernels->tier;
+}
+
+BigIntegerView::BigIntegerView()
+    : m_sign(Sign::POSITIVE), m_data(nullptr), m_size(0) {}
+
+BigIntegerView::BigIntegerView(Sign sign, const char *digits, int count)
+    : m_sign(sign), m_data(digits), m_size(count) {}
+
+BigIntegerView::BigIntegerView(const BigInteger &value)
+    : m_sign(value.m_sign), m_data(value.digits().data()),
+      m_size(value.count()) {}
+
+BigIntegerView::BigIntegerView(const SharedBigInteger &value)
+    : m_sign(value.sign()), m_data(value.data()), m_size(value.count()) {}
+
+Sign BigIntegerView::sign() const { return m_sign; }
+
+const char *BigIntegerView::data() const { return m_data; }
+
+int BigIntegerView::count() const { return m_size; }
+
+int BigIntegerView::get_digit(const int &pos) const {
+    if (pos >= 0 && pos < m_size)
+        return (m_data[pos] - '0');
+
+    return 0;
+}
+
+string BigIntegerView::to_string() const {
+    if (!m_size)
+        return "0";
+
+    // sized once, then filled by the reversing kernel
+    const int negative = m_sign == Sign::NEGATIVE;
+    string res(m_size + negative, '-');
+    detail::kernels().reverse(&res[negative], m_data, m_size);
+
+    return res;
+}
+
+size_t BigIntegerView::hash() const {
+    return hash_value(hash_digits(m_data, m_size), m_sign);
+}
+
+uint64_t BigIntegerView::hash_digits(const char *digits, int count) {
+    const uint64_t mul = 0x9e3779b97f4a7c15ULL;
+    uint64_t h = 0x243f6a8885a308d3ULL ^ uint64_t(count);
+
+    // eight digits per step; memcpy compiles to a plain unaligned load
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, digits + i, sizeof(word));
+        h = (h ^ word) * mul;
+        h ^= h >> 29;
+    }
+
+    uint64_t tail = 0;
+    if (i < count)
+        std::memcpy(&tail, digits + i, count - i);
+    h = (h ^ tail) * mul;
+
+    // murmur3 finalizer
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h ? h : 1;
+}
+
+size_t BigIntegerView::hash_value(uint64_t digits_hash, Sign sign) {
+    return size_t(sign == Sign::NEGATIVE ? ~digits_hash : digits_hash);
+}
+
+uint64_t BigIntegerView::residue() const {
+    // Horner's rule over chunks of up to 18 digits, most significant first;
+    // a chunk is below 10^18 < 2^61, so it needs no reduction
+    uint64_t residue = 0;
+    for (int i = m_size; i > 0;) {
+        const auto step = (i - 1) % 18 + 1;
+
+        uint64_t chunk = 0;
+        uint64_t scale = 1;
+        for (int k = i - 1; k >= i - step; --k) {
+            chunk = chunk * 10 + uint64_t(m_data[k] - '0');
+            scale *= 10;
+        }
+
+        residue =
+            detail::add_mod61(detail::mul_mod61(residue, scale), chunk);
+        i -= step;
+    }
+
+    return residue;
+}
+
+int BigIntegerView::compare_magnitude(BigIntegerView lhs, BigIntegerView rhs) {
+    if (lhs.m_size != rhs.m_size)
+        return lhs.m_size < rhs.m_size ? -1 : 1;
+
+    for (auto i = lhs.m_size - 1; i >= 0; --i) {
+        if (lhs.m_data[i] != rhs.m_data[i])
+            return lhs.m_data[i] < rhs.m_data[i] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+int BigIntegerView::compare(BigIntegerView lhs, BigIntegerView rhs) {
+    if (lhs.m_sign != rhs.m_sign)
+        return lhs.m_sign == Sign::NEGATIVE ? -1 : 1;
+
+    const auto res = compare_magnitude(lhs, rhs);
+    return lhs.m_sign == Sign::NEGATIVE ? -res : res;
+}
+
+bool operator==(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::compare(lhs, rhs) == 0;
+}
+
+bool operator!=(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::compare(lhs, rhs) != 0;
+}
+
+bool operator<(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::compare(lhs, rhs) < 0;
+}
+
+bool operator<=(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::compare(lhs, rhs) <= 0;
+}
+
+bool operator>(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::compare(lhs, rhs) > 0;
+}
+
+bool operator>=(BigIntegerView lhs, BigIntegerView rhs) {
+    return BigIntegerView::compare(lhs, rhs) >= 0;
+}
+
+ostream &operator<<(ostream &os, BigIntegerView rhs) {
+    os << rhs.to_string();
+    return os;
+}
+
+BigInteger::BigInteger()
+    : m_sign(Sign::POSITIVE), m_data(new_allocator()) {}
+
+BigInteger::BigInteger(int num)
+    : m_sign(Sign::POSITIVE), m_data(new_allocator()) {
+    // work on the unsigned magnitude so that INT_MIN does not overflow
+    auto mag = static_cast<unsigned>(num);
+    if (num < 0) {
+        this->m_sign = Sign::NEGATIVE;
+        mag = 0U - mag;
+    }
+
+    if (mag)
+        m_data.reserve(10);
+    while (mag) {
+        const auto rem = mag % BASE;
+        push_digit(rem);
+
+        mag /= 10;
+    }
+}
+
+BigInteger::BigInteger(const char *num)
+    : m_sign(Sign::POSITIVE), m_data(new_allocator()) {
+    parse(num);
+}
+
+BigInteger::BigInteger(const string &num)
+    : m_sign(Sign::POSITIVE), m_data(new_allocator()) {
+    parse(num.c_str());
+}
+
+BigInteger::BigInteger(BigIntegerView view)
+    : m_sign(view.sign()), m_data(new_allocator()) {
+    m_data.assign(view.data(), view.data() + view.count());
+}
+
+BigInteger::BigInteger(const BigInteger &rhs)
+    : m_sign(rhs.m_sign), m_data(new_allocator()), m_shared{},
+      m_hash(rhs.m_hash.load(std::memory_order_relaxed)),
+      m_residue(rhs.m_residue), m_residue_valid(rhs.m_residue_valid),
+      m_fingerprinted(rhs.m_fingerprinted) {
+    assign_digits(rhs);
+}
+
+BigInteger::BigInteger(const BigInteger &rhs, const allocator_type &alloc)
+    : m_sign(rhs.m_sign), m_data(rhs.digits(), alloc), m_shared{},
+      m_hash(rhs.m_hash.load(std::memory_order_relaxed)),
+      m_residue(rhs.m_residue), m_residue_valid(rhs.m_residue_valid),
+      m_fingerprinted(rhs.m_fingerprinted) {}
+
+BigInteger::BigInteger(BigInteger &&rhs)
+    : m_sign(rhs.m_sign), m_data(std::move(rhs.m_data)),
+      m_shared(std::move(rhs.m_shared)),
+      m_hash(rhs.m_hash.load(std::memory_order_relaxed)),
+      m_residue(rhs.m_residue), m_residue_valid(rhs.m_residue_valid),
+      m_fingerprinted(rhs.m_fingerprinted) {
+    rhs.clear_moved_from();
+}
+
+BigInteger &BigInteger::operator=(const BigInteger &rhs) {
+    if (this == &rhs)
+        return *this;
+
+    assign_digits(rhs);
+
+    m_sign = rhs.m_sign;
+    m_hash.store(rhs.m_hash.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    m_residue = rhs.m_residue;
+    m_residue_valid = rhs.m_residue_valid;
+    m_fingerprinted = rhs.m_fingerprinted;
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator=(BigInteger &&rhs) {
+    if (this == &rhs) {
+        return *this;
+    }
+
+    // steals the buffer when both share an allocator, copies into the
+    // existing capacity otherwise; a shared buffer follows the same rule
+    if (rhs.m_shared) {
+        assign_digits(rhs);
+    } else {
+        m_data = std::move(rhs.m_data);
+        m_shared.reset();
+    }
+
+    m_sign = rhs.m_sign;
+    m_hash.store(rhs.m_hash.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+    m_residue = rhs.m_residue;
+    m_residue_valid = rhs.m_residue_valid;
+    m_fingerprinted = rhs.m_fingerprinted;
+    rhs.clear_moved_from();
+
+    return *this;
+}
+
+BigInteger &BigInteger::operator=(BigIntegerView view) {
+    // the view may point into the digits being replaced
+    ScratchStack::Marker marker;
+    view = unaliased(view);
+
+    before_write();
+    m_data.assign(view.data(), view.data() + view.count());
+    m_sign = view.sign();
+
+    return *this;
+}
+
+BigInteger::~BigInteger() {
+    // cout << "dtor, see you later\n";
+}
+
+BigInteger::allocator_type BigInteger::get_allocator() const {
+    return digits().get_allocator();
+}
+
+void BigInteger::reserve(size_t digits) {
+    unshare();
+    m_data.reserve(digits);
+}
+
+size_t BigInteger::capacity() const { return digits().capacity(); }
+
+void BigInteger::shrink_to_fit() {
+    unshare();
+    m_data.shrink_to_fit();
+}
+
+BigInteger &BigInteger::share() {
+    if (m_shared)
+        return *this;
+
+    // the shared buffer and its reference count come from the same allocator
+    // as the digits
+    m_shared = std::allocate_shared<std::pmr::vector<char>>(
+        m_data.get_allocator(), std::move(m_data));
+    m_data.clear();
+
+    return *this;
+}
+
+bool BigInteger::is_shared() const { return m_shared != nullptr; }
+
+void BigInteger::clear_moved_from() {
+    m_data.clear();
+    m_shared.reset();
+    m_sign = Sign::POSITIVE;
+    m_hash.store(0, std::memory_order_relaxed);
+    m_residue = 0;
+    m_residue_valid = true;
+}
+
+void BigInteger::assign_digits(const BigInteger &rhs) {
+    if (rhs.m_shared &&
+        rhs.m_shared->get_allocator() == m_data.get_allocator()) {
+        m_shared = rhs.m_shared;
+        m_data.clear();
+        return;
+    }
+
+    // assign() keeps the current buffer whenever it is large enough
+    m_data.assign(rhs.digits().begin(), rhs.digits().end());
+    m_shared.reset();
+}
+
+size_t BigInteger::hash() const {
+    auto digits_hash = m_hash.load(std::memory_order_relaxed);
+    if (!digits_hash) {
+        digits_hash = BigIntegerView::hash_digits(digits().data(), count());
+        m_hash.store(digits_hash, std::memory_order_relaxed);
+    }
+
+    return BigIntegerView::hash_value(digits_hash, m_sign);
+}
+
+const std::pmr::vector<char> &BigInteger::digits() const {
+    return m_shared ? *m_shared : m_data;
+}
+
+void BigInteger::before_write() {
+    unshare();
+    m_hash.store(0, std::memory_order_relaxed);
+    m_residue_valid = false;
+}
+
+uint64_t BigInteger::signed_residue() const {
+    const auto residue = fingerprint();
+    return is_negative() ? detail::neg_mod61(residue) : residue;
+}
+
+void BigInteger::set_signed_residue(uint64_t residue) {
+    if (!m_fingerprinted)
+        return;
+
+    m_residue = is_negative() ? detail::neg_mod61(residue) : residue;
+    m_residue_valid = true;
+}
+
+void BigInteger::enable_fingerprint() {
+    m_residue = fingerprint();
+    m_residue_valid = true;
+    m_fingerprinted = true;
+}
+
+bool BigInteger::has_fingerprint() const { return m_residue_valid; }
+
+uint64_t BigInteger::fingerprint() const {
+    return m_residue_valid ? m_residue : BigIntegerView(*this).residue();
+}
+
+namespace detail {
+
+/**
+ * @brief The registered constants, bucketed by hash.
+ */
+struct InternRegistry {
+    std::mutex mutex;
+    std::unordered_multimap<size_t, const BigInteger *> constants;
+};
+
+InternRegistry &intern_registry() {
+    // leaked on purpose: constants may still be read during static
+    // destruction
+    static auto *registry = new InternRegistry;
+    return *registry;
+}
+
+} // namespace detail
+
+const BigInteger *BigInteger::make_constant(BigIntegerView value) {
+    // hook resources are never deleted, unlike an arena or a user resource,
+    // so the constant stays valid for the life of the program
+    auto *constant = new BigInteger(BigInteger(value),
+                                    allocator_type(detail::hook_resource().load()));
+    constant->m_residue = value.residue();
+    constant->m_residue_valid = true;
+    constant->share();
+
+    return constant;
+}
+
+const BigInteger &BigInteger::zero() { return intern(0); }
+
+const BigInteger &BigInteger::one() { return intern(1); }
+
+const BigInteger &BigInteger::intern(int value) {
+    // built once, so the common lookups skip the registry lock
+    static const auto small = [] {
+        vector<const BigInteger *> small;
+        small.reserve(INTERN_MAX - INTERN_MIN + 1);
+        for (int i = INTERN_MIN; i <= INTERN_MAX; ++i)
+            small.push_back(&intern(BigInteger(i)));
+        return small;
+    }();
+
+    if (value >= INTERN_MIN && value <= INTERN_MAX)
+        return *small[value - INTERN_MIN];
+
+    return intern(BigInteger(value));
+}
+
+const BigInteger &BigInteger::intern(BigIntegerView value) {
+    // a signed empty view is still zero
+    if (!value.count())
+        value = BigIntegerView();
+
+    auto &registry = detail::intern_registry();
+    const auto hash = value.hash();
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const auto range = registry.constants.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (BigIntegerView(*it->second) == value)
+            return *it->second;
+    }
+
+    const auto *constant = make_constant(value);
+    registry.constants.emplace(hash, constant);
+
+    return *constant;
+}
+
+void BigInteger::unshare() {
+    if (!m_shared)
+        return;
+
+    if (m_shared.use_count() == 1) {
+        // the last owner can take the buffer, once it has seen every write
+        // made by the owners that released it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        m_data = std::move(*m_shared);
+    } else {
+        m_data.assign(m_shared->begin(), m_shared->end());
+    }
+
+    m_shared.reset();
+}
+
+BigInteger &BigInteger::promote() {
+    unshare();
+
+    auto *resource = get_memory_resource();
+    if (m_data.get_allocator().resource() == resource)
+        return *this;
+
+    // polymorphic allocators never propagate on assignment, so the vector is
+    // rebuilt in place to take the new allocator along
+    std::pmr::vector<char> promoted(m_data, resource);
+    m_data.~vector();
+    ::new (&m_data) std::pmr::vector<char>(std::move(promoted));
+
+    return *this;
+}
+
+BigInteger::allocator_type BigInteger::new_allocator() {
+    if (auto *arena = ArenaScope::current())
+        return arena;
+    return get_memory_resource();
+}
+
+void BigInteger::parse(const char *str) {
+    int len = strlen(str);
+    int iter = 0;
+
+    if (str[0] == '-') {
+        m_sign = Sign::NEGATIVE;
+        iter = 1;
+    }
+
+    int digits = 0;
+    for (int i = iter; i < len; ++i) {
+        if (str[i] != '_')
+            ++digits;
+    }
+
+    // digits are stored least significant first, so fill from the back
+    m_data.resize(digits);
+    if (digits == len - iter) {
+        detail::kernels().reverse(m_data.data(), str + iter, digits);
+        normalize();
+        return;
+    }
+
+    for (; iter < len; ++iter) {
+        if (str[iter] == '_') {
+            // ignore
+        } else {
+            m_data[--digits] = str[iter];
+        }
+    }
+
+    normalize();
+}
+
+BigInteger BigInteger::operator+(const BigInteger &rhs) const {
+    return *this + BigIntegerView(rhs);
+}
+
+BigInteger &BigInteger::operator+=(const BigInteger &rhs) {
+    return *this += BigIntegerView(rhs);
+}
+
+BigInteger BigInteger::operator+(BigIntegerView rhs) const {
+    BigInteger res;
+    res.reserve(std::max(count(), rhs.count()) + 1);
+    res = *this;
+    res += rhs;
+    return res;
+}
+
+BigInteger &BigInteger::operator+=(BigIntegerView rhs) {
+    ScratchStack::Marker marker;
+    if (rhs.count() <= SMALL_DIGITS) {
+        add_signed_1(small_magnitude(rhs), rhs.sign());
+        return *this;
+    }
+
+    rhs = unaliased(rhs);
+
+    uint64_t residue = 0;
+    if (m_fingerprinted) {
+        const auto rhs_residue = rhs.sign() == Sign::NEGATIVE
+                                     ? detail::neg_mod61(rhs.residue())
+                                     : rhs.residue();
+        residue = detail::add_mod61(signed_residue(), rhs_residue);
+    }
+
+    add_signed(rhs, rhs.sign());
+    set_signed_residue(residue);
+    return *this;
+}
+
+BigInteger BigInteger::operator-(const BigInteger &rhs) const {
+    return *this - BigIntegerView(rhs);
+}
+
+BigInteger &BigInteger::operator-=(const BigInteger &rhs) {
+    if (this == &rhs) {
+        const bool fingerprinted = m_fingerprinted;
+        *this = zero();
+        m_fingerprinted = fingerprinted;
+        set_signed_residue(0);
+        return *this;
+    }
+
+    return *this -= BigIntegerView(rhs);
+}
+
+BigInteger BigInteger::operator-(BigIntegerView rhs) const {
+    BigInteger res;
+    res.reserve(std::max(count(), rhs.count()) + 1);
+    res = *this;
+    res -= rhs;
+    return res;
+}
+
+BigInteger &BigInteger::operator-=(BigIntegerView rhs) {
+    ScratchStack::Marker marker;
+    if (rhs.count() <= SMALL_DIGITS) {
+        add_signed_1(small_magnitude(rhs), rhs.sign() == Sign::POSITIVE
+                                               ? Sign::NEGATIVE
+                                               : Sign::POSITIVE);
+        return *this;
+    }
+
+    rhs = unaliased(rhs);
+
+    uint64_t residue = 0;
+    if (m_fingerprinted) {
+        const auto rhs_residue = rhs.sign() == Sign::NEGATIVE
+                                     ? rhs.residue()
+                                     : detail::neg_mod61(rhs.residue());
+        residue = detail::add_mod61(signed_residue(), rhs_residue);
+    }
+
+    add_signed(rhs, rhs.sign() == Sign::POSITIVE ? Sign::NEGATIVE
+                                                 : Sign::POSITIVE);
+    set_signed_residue(residue);
+    return *this;
+}
+
+BigIntegerView BigInteger::unaliased(BigIntegerView rhs) const {
+    const auto *begin = digits().data();
+    const auto *end = begin + digits().size();
+    if (!rhs.count() || rhs.data() + rhs.count() <= begin || end <= rhs.data())
+        return rhs;
+
+    auto *copy = ScratchStack::local().alloc<char>(rhs.count());
+    std::memcpy(copy, rhs.data(), rhs.count());
+
+    return BigIntegerView(rhs.sign(), copy, rhs.count());
+}
+
+void BigInteger::add_signed(BigIntegerView rhs, Sign rhs_sign) {
+    if (m_sign == rhs_sign) {
+        add_magnitude(rhs);
+        return;
+    }
+
+    if (compare_magnitude(rhs) >= 0) {
+        sub_magnitude(rhs);
+        return;
+    }
+
+    // |rhs| wins, so the result takes the sign of rhs
+    rsub_magnitude(rhs);
+    m_sign = rhs_sign;
+}
+
+void BigInteger::add_magnitude(BigIntegerView rhs) {
+    const auto l_size = this->count();
+    const auto r_size = rhs.count();
+
+    charge_budget(std::max(l_size, r_size));
+    reserve(std::max(l_size, r_size) + 1);
+    before_write();
+    if (l_size < r_size)
+        m_data.resize(r_size, '0');
+
+    auto carry = detail::kernels().add_n(m_data.data(), m_data.data(),
+                                         rhs.data(), r_size, 0);
+
+    // past rhs only the carry is left to add
+    for (int i = r_size; carry && i < count(); ++i) {
+        carry = m_data[i] == '9';
+        m_data[i] = carry ? '0' : char(m_data[i] + 1);
+    }
+
+    if (carry)
+        push_digit(carry);
+}
+
+void BigInteger::sub_magnitude(BigIntegerView rhs) {
+    const auto r_size = rhs.count();
+
+    charge_budget(count());
+    before_write();
+
+    auto borrow = detail::kernels().sub_n(m_data.data(), m_data.data(),
+                                          rhs.data(), r_size, 0);
+
+    for (int i = r_size; borrow && i < count(); ++i) {
+        borrow = m_data[i] == '0';
+        m_data[i] = borrow ? '9' : char(m_data[i] - 1);
+    }
+    normalize();
+}
+
+void BigInteger::rsub_magnitude(BigIntegerView rhs) {
+    const auto r_size = rhs.count();
+
+    charge_budget(r_size);
+    before_write();
+    m_data.resize(r_size, '0');
+
+    // |rhs| > |this|, so there is no borrow out
+    detail::kernels().sub_n(m_data.data(), rhs.data(), m_data.data(), r_size,
+                            0);
+    normalize();
+}
+
+BigInteger BigInteger::operator*(const BigInteger &rhs) const {
+    return *this * BigIntegerView(rhs);
+}
+
+BigInteger &BigInteger::operator*=(const BigInteger &rhs) {
+    return *this *= BigIntegerView(rhs);
+}
+
+BigInteger BigInteger::operator*(BigIntegerView rhs) const {
+    BigInteger res;
+    res.reserve(count() + rhs.count());
+    res = *this;
+    res *= rhs;
+    return res;
+}
+
+BigInteger &BigInteger::operator*=(BigIntegerView rhs) {
+    const auto l_size = this->count();
+    const auto r_size = rhs.count();
+
+    const bool fingerprinted = m_fingerprinted;
+    if (!l_size || !r_size) {
+        *this = zero();
+        m_fingerprinted = fingerprinted;
+        set_signed_residue(0);
+        return *this;
+    }
+
+    // a single word operand needs one pass over the other one
+    if (r_size <= SMALL_DIGITS) {
+        mul_signed_1(small_magnitude(rhs), rhs.sign());
+        return *this;
+    }
+    if (l_size <= SMALL_DIGITS) {
+        // the product is built aside, so a throw leaves *this unchanged
+        BigInteger res(rhs);
+        res.mul_signed_1(small_magnitude(*this), m_sign);
+        const auto residue =
+            fingerprinted ? detail::mul_mod61(fingerprint(), rhs.residue()) : 0;
+
+        *this = BigIntegerView(res);
+        if (fingerprinted) {
+            m_residue = residue;
+            m_residue_valid = true;
+        }
+        return *this;
+    }
+
+    // scaling by a power of ten is a shift; the check stops at the first
+    // nonzero digit, which is almost always the first one read
+    if (rhs.data()[r_size - 1] == '1' &&
+        std::all_of(rhs.data(), rhs.data() + r_size - 1,
+                    [](char digit) { return digit == '0'; })) {
+        // the sign changes only once mul_pow10 has been charged and succeeded
+        mul_pow10(r_size - 1);
+        if (rhs.sign() == Sign::NEGATIVE)
+            m_sign = is_positive() ? Sign::NEGATIVE : Sign::POSITIVE;
+        return *this;
+    }
+
+    // magnitudes multiply regardless of the signs
+    const auto residue =
+        fingerprinted ? detail::mul_mod61(fingerprint(), rhs.residue()) : 0;
+
+    bool negate_it = false;
+    if (this->m_sign != rhs.sign())
+        negate_it = true;
+
+    // columns are summed in scratch memory and *this is only touched once the
+    // product is complete, which also makes rhs aliasing *this harmless
+    ScratchStack::Marker marker;
+    auto &scratch = ScratchStack::local();
+    const auto size = detail::limb_count(l_size) + detail::limb_count(r_size);
+    auto *cols = scratch.alloc<uint64_t>(size);
+    auto *digits = scratch.alloc<char>(size_t(size) * detail::LIMB_DIGITS);
+    mul_window(*this, rhs, 0, size, cols);
+    detail::from_limbs(cols, size, digits);
+
+    // the limbs pad the product with zeros; only its l_size + r_size digits
+    // at most are copied, so a buffer reserved for those is reused
+    auto len = size_t(size) * detail::LIMB_DIGITS;
+    while (len && digits[len - 1] == '0')
+        --len;
+
+    before_write();
+    m_data.assign(digits, digits + len);
+
+    m_sign = negate_it ? Sign::NEGATIVE : Sign::POSITIVE;
+    normalize();
+    if (fingerprinted) {
+        m_residue = residue;
+        m_residue_valid = true;
+    }
+
+    return *this;
+}
+
+BigInteger BigInteger::operator*(const int &num) const {
+    BigInteger res;
+    res.reserve(count() + 10);
+    res = *this;
+    res *= num;
+    return res;
+}
+
+BigInteger &BigInteger::operator*=(const int &num) {
+    if (num == 0) {
+        const bool fingerprinted = m_fingerprinted;
+        *this = zero();
+        m_fingerprinted = fingerprinted;
+        set_signed_residue(0);
+        return *this;
+    }
+
+    if (num == 1)
+        return *this;
+
+    // the unsigned magnitude keeps INT_MIN from overflowing
+    mul_signed_1(num < 0 ? 0U - static_cast<unsigned>(num)
+                         : static_cast<unsigned>(num),
+                 num < 0 ? Sign::NEGATIVE : Sign::POSITIVE);
+
+    return *this;
+}
+
+BigInteger BigInteger::operator+(const int &num) const {
+    BigInteger res;
+    res.reserve(count() + 1);
+    res = *this;
+    res += num;
+    return res;
+}
+
+BigInteger &BigInteger::operator+=(const int &num) {
+    add_signed_1(num < 0 ? 0U - static_cast<unsigned>(num)
+                         : static_cast<unsigned>(num),
+                 num < 0 ? Sign::NEGATIVE : Sign::POSITIVE);
+    return *this;
+}
+
+BigInteger BigInteger::operator-(const int &num) const {
+    BigInteger res;
+    res.reserve(count() + 1);
+    res = *this;
+    res -= num;
+    return res;
+}
+
+BigInteger &BigInteger::operator-=(const int &num) {
+    add_signed_1(num < 0 ? 0U - static_cast<unsigned>(num)
+                         : static_cast<unsigned>(num),
+                 num < 0 ? Sign::POSITIVE : Sign::NEGATIVE);
+    return *this;
+}
+
+BigInteger BigInteger::operator/(const int &num) const {
+    BigInteger res;
+    res.reserve(count());
+    res = *this;
+    res /= num;
+    return res;
+}
+
+BigInteger &BigInteger::operator/=(const int &num) {
+    if (num == 0)
+        throw std::domain_error("division by zero");
+
+    // the sign changes only once divrem_1 has been charged and succeeded
+    divrem_1(num < 0 ? 0U - static_cast<unsigned>(num)
+                     : static_cast<unsigned>(num));
+    if (num < 0 && count())
+        m_sign = is_positive() ? Sign::NEGATIVE : Sign::POSITIVE;
+
+    // the quotient has no cheap residue, so take it from the digits
+    if (m_fingerprinted)
+        enable_fingerprint();
+
+    return *this;
+}
+
+int BigInteger::operator%(const int &num) const {
+    if (num == 0)
+        throw std::domain_error("division by zero");
+
+    const auto divisor =
+        num < 0 ? 0U - static_cast<unsigned>(num) : static_cast<unsigned>(num);
+
+    // the remainder needs no quotient, so nothing is written
+    charge_budget(count());
+    const auto &digits = this->digits();
+    unsigned long long rem = 0;
+    for (auto i = count() - 1; i >= 0; --i)
+        rem = (rem * BASE + (digits[i] - '0')) % divisor;
+
+    return is_negative() ? -static_cast<int>(rem) : static_cast<int>(rem);
+}
+
+BigInteger &BigInteger::operator++() {
+    // crossing zero from below is a borrow on the magnitude
+    add_signed_1(1, Sign::POSITIVE);
+    return *this;
+}
+
+BigInteger BigInteger::operator++(int) {
+    BigInteger res(*this);
+    ++*this;
+    return res;
+}
+
+BigInteger &BigInteger::operator--() {
+    add_signed_1(1, Sign::NEGATIVE);
+    return *this;
+}
+
+BigInteger BigInteger::operator--(int) {
+    BigInteger res(*this);
+    --*this;
+    return res;
+}
+
+BigInteger &BigInteger::mul_pow10(int k) {
+    if (k < 0)
+        throw std::invalid_argument("negative power of ten");
+    if (!count() || !k)
+        return *this;
+
+    charge_budget(uint64_t(count()) + k);
+
+    // 10^k by square and multiply, so the residue moves in O(log k)
+    uint64_t residue = 0;
+    if (m_fingerprinted) {
+        uint64_t scale = 1;
+        uint64_t base = BASE;
+        for (auto e = k; e; e >>= 1) {
+            if (e & 1)
+                scale = detail::mul_mod61(scale, base);
+            base = detail::mul_mod61(base, base);
+        }
+        residue = detail::mul_mod61(fingerprint(), scale);
+    }
+
+    reserve(size_t(count()) + k);
+    before_write();
+    m_data.insert(m_data.begin(), size_t(k), '0');
+
+    if (m_fingerprinted) {
+        m_residue = residue;
+        m_residue_valid = true;
+    }
+
+    return *this;
+}
+
+BigInteger &BigInteger::div_pow10(int k) {
+    if (k < 0)
+        throw std::invalid_argument("negative power of ten");
+    if (!k)
+        return *this;
+
+    charge_budget(count());
+    before_write();
+    m_data.erase(m_data.begin(), m_data.begin() + std::min(k, count()));
+    normalize();
+
+    // the quotient has no cheap residue, so take it from the digits
+    if (m_fingerprinted)
+        enable_fingerprint();
+
+    return *this;
+}
+
+BigInteger &BigInteger::divrem_pow10(int k, BigInteger &remainder) {
+    if (k < 0)
+        throw std::invalid_argument("negative power of ten");
+
+    // built aside, in case remainder is *this
+    BigInteger low(
+        BigIntegerView(m_sign, digits().data(), std::min(k, count())));
+    low.normalize();
+
+    div_pow10(k);
+    remainder = std::move(low);
+
+    return *this;
+}
+
+void BigInteger::mul_window(BigIntegerView lhs, BigIntegerView rhs, int from,
+                            int to, uint64_t *cols) {
+    // digits above the window never reach it
+    const auto reach = size_t(to) * detail::LIMB_DIGITS;
+    auto &scratch = ScratchStack::local();
+    auto *a = scratch.alloc<uint32_t>(detail::limb_count(lhs.count()));
+    auto *b = scratch.alloc<uint32_t>(detail::limb_count(rhs.count()));
+    const auto a_size = detail::to_limbs(
+        lhs.data(), int(std::min<size_t>(lhs.count(), reach)), a);
+    const auto b_size = detail::to_limbs(
+        rhs.data(), int(std::min<size_t>(rhs.count(), reach)), b);
+
+    // nine digits per limb cut the inner products 81-fold; each product is
+    // below 10^18, so a column takes LIMB_ROWS of them before its carries
+    // have to be pushed up
+    const auto size = to - from;
+    std::fill(cols, cols + size, uint64_t(0));
+
+    const auto addmul_1 = detail::kernels().addmul_1;
+    int rows = 0;
+    for (int j = 0; j < b_size && j < to; ++j) {
+        const auto first = std::max(0, from - j);
+        const auto last = std::min(a_size, to - j);
+        if (first >= last)
+            continue;
+
+        charge_budget(uint64_t(last - first) * detail::LIMB_DIGITS *
+                      detail::LIMB_DIGITS);
+        if (b[j])
+            addmul_1(cols + (j + first - from), a + first, last - first, b[j]);
+        if (++rows % detail::LIMB_ROWS == 0)
+            detail::carry_limbs(cols, size);
+    }
+    detail::carry_limbs(cols, size);
+}
+
+BigInteger BigInteger::mullo(BigIntegerView lhs, BigIntegerView rhs, int n) {
+    if (n < 0)
+        throw std::invalid_argument("negative digit count");
+
+    ScratchStack::Marker marker;
+    const auto size =
+        std::min(detail::limb_count(n), detail::limb_count(lhs.count()) +
+                                            detail::limb_count(rhs.count()));
+    auto *cols = ScratchStack::local().alloc<uint64_t>(size);
+    mul_window(lhs, rhs, 0, size, cols);
+
+    BigInteger res;
+    res.m_data.resize(size_t(size) * detail::LIMB_DIGITS);
+    detail::from_limbs(cols, size, res.m_data.data());
+    res.m_data.resize(std::min(res.m_data.size(), size_t(n)));
+    res.m_sign = lhs.sign() != rhs.sign() ? Sign::NEGATIVE : Sign::POSITIVE;
+    res.normalize();
+
+    return res;
+}
+
+BigInteger BigInteger::mulhi(BigIntegerView lhs, BigIntegerView rhs, int n) {
+    if (n < 0)
+        throw std::invalid_argument("negative digit count");
+
+    const auto total =
+        detail::limb_count(lhs.count()) + detail::limb_count(rhs.count());
+    if (size_t(n) >= size_t(total) * detail::LIMB_DIGITS)
+        return BigInteger();
+
+    // the columns below from are skipped; their products sum to less than
+    // LIMB_BASE^(from + 2), which can only carry into digit n if every digit
+    // between there and n is a nine
+    const auto from =
+        std::max(0, n / detail::LIMB_DIGITS - detail::MULHI_GUARD_LIMBS);
+    const auto size = total - from;
+    const auto drop = n - from * detail::LIMB_DIGITS;
+
+    ScratchStack::Marker marker;
+    auto &scratch = ScratchStack::local();
+    auto *cols = scratch.alloc<uint64_t>(size);
+    auto *digits = scratch.alloc<char>(size_t(size) * detail::LIMB_DIGITS);
+    mul_window(lhs, rhs, from, total, cols);
+    detail::from_limbs(cols, size, digits);
+
+    const char *exact = digits + 2 * detail::LIMB_DIGITS;
+    const char *end = digits + drop;
+    if (from && std::all_of(exact, end,
+                            [](char digit) { return digit == '9'; })) {
+        BigInteger res(lhs);
+        res *= rhs;
+        return res.div_pow10(n);
+    }
+
+    BigInteger res(BigIntegerView(
+        lhs.sign() != rhs.sign() ? Sign::NEGATIVE : Sign::POSITIVE,
+        digits + drop, size * detail::LIMB_DIGITS - drop));
+    res.normalize();
+
+    return res;
+}
+
+BigInteger BigInteger::mulmid(BigIntegerView lhs, BigIntegerView rhs,
+                              int from, int to) {
+    if (from < 0 || to < from)
+        throw std::invalid_argument("invalid digit range");
+
+    // widen the range to whole limbs; the columns below first are what a
+    // middle product leaves out, and their sum is below LIMB_BASE^(first + 2)
+    const auto total =
+        detail::limb_count(lhs.count()) + detail::limb_count(rhs.count());
+    const auto first = from / detail::LIMB_DIGITS;
+    const auto last = std::min(detail::limb_count(to), total);
+    if (first >= last)
+        return BigInteger();
+
+    const auto size = last - first;
+    const auto skip = from - first * detail::LIMB_DIGITS;
+    const auto keep = std::min(to, last * detail::LIMB_DIGITS) - from;
+
+    ScratchStack::Marker marker;
+    auto &scratch = ScratchStack::local();
+    auto *cols = scratch.alloc<uint64_t>(size);
+    auto *digits = scratch.alloc<char>(size_t(size) * detail::LIMB_DIGITS);
+    mul_window(lhs, rhs, first, last, cols);
+    detail::from_limbs(cols, size, digits);
+
+    BigInteger res(BigIntegerView(
+        lhs.sign() != rhs.sign() ? Sign::NEGATIVE : Sign::POSITIVE,
+        digits + skip, keep));
+    res.normalize();
+
+    return res;
+}
+
+BigInteger &BigInteger::mul_mod_pow10(BigIntegerView rhs, int k) {
+    const bool fingerprinted = m_fingerprinted;
+    *this = mullo(*this, rhs, k);
+    if (fingerprinted)
+        enable_fingerprint();
+
+    return *this;
+}
+
+BigInteger &BigInteger::mul_mod_pow2(BigIntegerView rhs, int k) {
+    // the work happens on local values, so a throw leaves *this unchanged
+    auto high = mullo(*this, rhs, k);
+    const auto sign = high.m_sign;
+
+    // peel the low k bits off 29 at a time, then rebuild them from the top;
+    // O(k^2 / 29), like the product itself
+    const int chunk_bits = 29;
+    const auto chunks = (k + chunk_bits - 1) / chunk_bits;
+    ScratchStack::Marker marker;
+    auto *low = ScratchStack::local().alloc<unsigned>(chunks);
+
+    int used = 0;
+    for (; used < chunks && high.count(); ++used) {
+        const auto bits = std::min(chunk_bits, k - used * chunk_bits);
+        low[used] = high.divrem_1(1U << bits);
+    }
+
+    BigInteger res;
+    for (auto i = used - 1; i >= 0; --i) {
+        res.mul_1(1U << std::min(chunk_bits, k - i * chunk_bits));
+        res.add_1(low[i]);
+    }
+    res.m_sign = sign;
+    res.normalize();
+
+    const bool fingerprinted = m_fingerprinted;
+    *this = std::move(res);
+    if (fingerprinted)
+        enable_fingerprint();
+
+    return *this;
+}
+
+void BigInteger::add_1(unsigned num) {
+    // num has at most ten digits; a carry rippling through nines past them is
+    // not charged
+    charge_budget(std::min(count(), 10) + 1);
+    before_write();
+
+    unsigned long long carry = num;
+    for (int i = 0; carry && i < count(); ++i) {
+        carry += m_data[i] - '0';
+        m_data[i] = char(carry % BASE + '0');
+        carry /= BASE;
+    }
+
+    while (carry) {
+        push_digit(carry % BASE);
+        carry /= BASE;
+    }
+}
+
+void BigInteger::sub_1(unsigned num) {
+    charge_budget(std::min(count(), 10) + 1);
+    before_write();
+
+    // borrow holds what is still to be subtracted from digit i onward
+    unsigned long long borrow = num;
+    for (int i = 0; borrow && i < count(); ++i) {
+        int diff = (m_data[i] - '0') - int(borrow % BASE);
+        borrow /= BASE;
+        if (diff < 0) {
+            diff += BASE;
+            ++borrow;
+        }
+        m_data[i] = char(diff + '0');
+    }
+    normalize();
+}
+
+void BigInteger::mul_1(unsigned num) {
+    charge_budget(count());
+
+    // the carry stays below num, so it adds at most ten digits
+    reserve(count() + 10);
+    before_write();
+
+    // multiply a positive machine word to BigInteger
+    unsigned long long carry = 0;
+    for (auto &digit : m_data) {
+        const auto product = 1ULL * num * (digit - '0') + carry;
+        carry = product / BASE;
+        digit = char(product % BASE + '0');
+    }
+
+    while (carry) {
+        m_data.push_back(char(carry % BASE + '0'));
+        carry /= BASE;
+    }
+    normalize();
+}
+
+unsigned BigInteger::divrem_1(unsigned num) {
+    charge_budget(count());
+    before_write();
+
+    unsigned long long rem = 0;
+    for (auto i = count() - 1; i >= 0; --i) {
+        rem = rem * BASE + (m_data[i] - '0');
+        m_data[i] = char(rem / num + '0');
+        rem %= num;
+    }
+    normalize();
+
+    return unsigned(rem);
+}
+
+void BigInteger::add_signed_1(unsigned num, Sign sign) {
+    uint64_t residue = 0;
+    if (m_fingerprinted) {
+        residue = detail::add_mod61(signed_residue(),
+                                    sign == Sign::NEGATIVE
+                                        ? detail::neg_mod61(num)
+                                        : num);
+    }
+
+    // the sign changes only after the digits have been charged and written
+    if (!count() || m_sign == sign) {
+        add_1(num);
+        if (num)
+            m_sign = sign;
+    } else if (count() > SMALL_DIGITS + 1 || small_magnitude(*this) >= num) {
+        sub_1(num);
+    } else {
+        // |num| wins, so the result takes its sign
+        auto magnitude = unsigned(num - small_magnitude(*this));
+        charge_budget(count() + 1);
+        before_write();
+        m_data.clear();
+        for (; magnitude; magnitude /= BASE)
+            m_data.push_back(char(magnitude % BASE + '0'));
+        m_sign = sign;
+    }
+
+    set_signed_residue(residue);
+}
+
+void BigInteger::mul_signed_1(unsigned num, Sign sign) {
+    const auto residue =
+        m_fingerprinted ? detail::mul_mod61(fingerprint(), num) : 0;
+
+    // the sign changes only once mul_1 has been charged and succeeded
+    mul_1(num);
+    if (sign == Sign::NEGATIVE && count())
+        m_sign = is_positive() ? Sign::NEGATIVE : Sign::POSITIVE;
+
+    if (m_fingerprinted) {
+        m_residue = residue;
+        m_residue_valid = true;
+    }
+}
+
+unsigned long long BigInteger::small_magnitude(BigIntegerView value) {
+    unsigned long long magnitude = 0;
+    for (auto i = value.count() - 1; i >= 0; --i)
+        magnitude = magnitude * BASE + unsigned(value.data()[i] - '0');
+
+    return magnitude;
+}
+
+void BigInteger::charge_budget(unsigned long long digit_ops) {
+    if (auto *budget = ComputeBudget::current())
+        budget->charge(digit_ops);
+}
+
+bool operator==(const BigInteger &lhs, const BigInteger &rhs) {
+    return lhs.equal(rhs);
+}
+
+bool operator!=(const BigInteger &lhs, const BigInteger &rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator<(const BigInteger &lhs, const BigInteger &rhs) {
+    return lhs.less_than(rhs);
+}
+
+bool operator<=(const BigInteger &lhs, const BigInteger &rhs) {
+    return (lhs == rhs) || (lhs < rhs);
+}
+
+bool operator>(const BigInteger &lhs, const BigInteger &rhs) {
+    return rhs < lhs;
+}
+
+bool operator>=(const BigInteger &lhs, const BigInteger &rhs) {
+    return (lhs == rhs) || (lhs > rhs);
+}
+
+int BigInteger::count() const { return this->digits().size(); }
+
+void BigInteger::push_digit(const int &val) {
+    before_write();
+    this->m_data.push_back(char(val + '0'));
+}
+
+void BigInteger::change_digit(const int &pos, const int &val) {
+    before_write();
+
+    int len = count();
+    if (pos >= 0 && pos < len) {
+        this->m_data[pos] = char(val + '0');
+        return;
+    }
+
+    throw "Invalid position : " + std::to_string(pos);
+}
+
+int BigInteger::get_digit(const int &pos) const {
+    const auto len = count();
+
+    if (pos >= 0 && pos < len)
+        return (digits()[pos] - '0');
+
+    return 0;
+}
+
+string BigInteger::to_string() const {
+    return BigIntegerView(*this).to_string();
+}
+
+void BigInteger::normalize() {
+    before_write();
+
+    const auto len = count();
+    for (int i = len - 1; i >= 0; --i) {
+        if (get_digit(i) != 0)
+            break;
+        else {
+            if (m_data.size())
+                m_data.pop_back();
+        }
+    }
+
+    // zero is always positive
+    if (m_data.empty())
+        m_sign = Sign::POSITIVE;
+}
+
+bool BigInteger::equal(const BigInteger &rhs) const {
+    // copies of a shared value compare without a scan
+    if (m_shared && m_shared == rhs.m_shared)
+        return m_sign == rhs.m_sign;
+
+    // different residues prove the values differ; equal ones prove nothing
+    if (m_residue_valid && rhs.m_residue_valid && m_residue != rhs.m_residue)
+        return false;
+
+    return BigIntegerView::compare(*this, rhs) == 0;
+}
+
+int BigInteger::compare_magnitude(BigIntegerView rhs) const {
+    return BigIntegerView::compare_magnitude(*this, rhs);
+}
+
+bool BigInteger::less_than(const BigInteger &rhs) const {
+    return BigIntegerView::compare(*this, rhs) < 0;
+}
+
+bool BigInteger::is_positive() const { return this->m_sign == Sign::POSITIVE; }
+
+bool BigInteger::is_negative() const { return this->m_sign == Sign::NEGATIVE; }
+
+ostream &operator<<(ostream &os, const BigInteger &rhs) {
+    os << rhs.to_string();
+    return os;
+}
+
+istream &operator>>(istream &is, BigInteger &rhs) {
+    string str;
+    is >> str;
+
+    rhs = BigInteger(str);
+    return is;
+}
+
+SharedBigInteger::SharedBigInteger() : m_header(nullptr) {}
+
+SharedBigInteger::SharedBigInteger(const BigInteger &value)
+    : m_header(nullptr) {
+    const auto &digits = value.digits();
+    if (digits.empty())
+        return;
+
+    auto *resource = get_memory_resource();
+    void *raw =
+        resource->allocate(sizeof(Header) + digits.size(), alignof(Header));
+
+    m_header = ::new (raw)
+        Header{{1}, resource, digits.size(), value.m_sign,
+               BigIntegerView::hash_digits(digits.data(), digits.size())};
+    std::memcpy(reinterpret_cast<char *>(m_header + 1), digits.data(),
+                digits.size());
+}
+
+SharedBigInteger::SharedBigInteger(const SharedBigInteger &rhs)
+    : m_header(rhs.m_header) {
+    if (m_header)
+        m_header->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+SharedBigInteger::SharedBigInteger(SharedBigInteger &&rhs) noexcept
+    : m_header(rhs.m_header) {
+    rhs.m_header = nullptr;
+}
+
+SharedBigInteger &SharedBigInteger::operator=(const SharedBigInteger &rhs) {
+    if (rhs.m_header)
+        rhs.m_header->refs.fetch_add(1, std::memory_order_relaxed);
+
+    release();
+    m_header = rhs.m_header;
+
+    return *this;
+}
+
+SharedBigInteger &SharedBigInteger::operator=(SharedBigInteger &&rhs) noexcept {
+    if (this == &rhs)
+        return *this;
+
+    release();
+    m_header = rhs.m_header;
+    rhs.m_header = nullptr;
+
+    return *this;
+}
+
+SharedBigInteger::~SharedBigInteger() { release(); }
+
+void SharedBigInteger::release() {
+    if (!m_header)
+        return;
+
+    if (m_header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        auto *resource = m_header->resource;
+        const auto bytes = sizeof(Header) + m_header->size;
+
+        m_header->~Header();
+        resource->deallocate(m_header, bytes, alignof(Header));
+    }
+
+    m_header = nullptr;
+}
+
+const char *SharedBigInteger::digits_of(const Header *header) {
+    return reinterpret_cast<const char *>(header + 1);
+}
+
+size_t SharedBigInteger::count() const {
+    return m_header ? m_header->size : 0;
+}
+
+Sign SharedBigInteger::sign() const {
+    return m_header ? m_header->sign : Sign::POSITIVE;
+}
+
+const char *SharedBigInteger::data() const {
+    return m_header ? digits_of(m_header) : nullptr;
+}
+
+size_t SharedBigInteger::use_count() const {
+    return m_header ? m_header->refs.load(std::memory_order_relaxed) : 0;
+}
+
+BigInteger SharedBigInteger::to_big_integer() const {
+    return BigInteger(BigIntegerView(*this));
+}
+
+size_t SharedBigInteger::hash() const {
+    return m_header ? BigIntegerView::hash_value(m_header->hash, m_header->sign)
+                    : BigIntegerView().hash();
+}
+
+int SharedBigInteger::compare(const SharedBigInteger &lhs,
+                              const SharedBigInteger &rhs) {
+    if (lhs.m_header == rhs.m_header)
+        return 0;
+
+    return BigIntegerView::compare(lhs, rhs);
+}
+
+bool operator==(const SharedBigInteger &lhs, const SharedBigInteger &rhs) {
+    return SharedBigInteger::compare(lhs, rhs) == 0;
+}
+
+bool operator!=(const SharedBigInteger &lhs, const SharedBigInteger &rhs) {
+    return SharedBigInteger::compare(lhs, rhs) != 0;
+}
+
+bool operator<(const SharedBigInteger &lhs, const SharedBigInteger &rhs) {
+    return SharedBigInteger::compare(lhs, rhs) < 0;
+}
+
+bool operator<=(const SharedBigInteger &lhs, const SharedBigInteger &rhs) {
+    return SharedBigInteger::compare(lhs, rhs) <= 0;
+}
+
+bool operator>(const SharedBigInteger &lhs, const SharedBigInteger &rhs) {
+    return SharedBigInteger::compare(lhs, rhs) > 0;
+}
+
+bool operator>=(const SharedBigInteger &lhs, const SharedBigInteger &rhs) {
+    return SharedBigInteger::compare(lhs, rhs) >= 0;
+}
+
+ostream &operator<<(ostream &os, const SharedBigInteger &rhs) {
+    os << BigIntegerView(rhs);
+    return os;
+}
+
+BigIntegerVector::BigIntegerVector(std::pmr::memory_resource *resource)
+    : m_pool(resource ? resource : get_memory_resource()),
+      m_entries(resource ? resource : get_memory_resource()), m_garbage(0) {}
+
+size_t BigIntegerVector::size() const { return m_entries.size(); }
+
+bool BigIntegerVector::empty() const { return m_entries.empty(); }
+
+size_t BigIntegerVector::pool_size() const { return m_pool.size(); }
+
+size_t BigIntegerVector::garbage() const { return m_garbage; }
+
+void BigIntegerVector::reserve(size_t values, size_t digits) {
+    m_entries.reserve(values);
+    m_pool.reserve(digits);
+}
 
-BigInteger::BigInteger(int num) : m_sign(Sign::POSITIVE), m_data{} {
-    if (num < 0) {
-        this->m_sign = Sign::NEGATIVE;
-        num *= -1;
+size_t BigIntegerVector::append_digits(BigIntegerView value) {
+    const auto offset = m_pool.size();
+    const auto *begin = m_pool.data();
+
+    if (value.data() >= begin && value.data() < begin + m_pool.size()) {
+        // growing the pool may move the digits, so copy them by offset
+        const auto from = value.data() - begin;
+        m_pool.resize(offset + value.count());
+        std::memcpy(m_pool.data() + offset, m_pool.data() + from,
+                    value.count());
+    } else {
+        m_pool.insert(m_pool.end(), value.data(),
+                      value.data() + value.count());
     }
 
-    while (num) {
-        const auto rem = num % BASE;
-        push_digit(rem);
+    return offset;
+}
 
-        num /= 10;
-    }
+void BigIntegerVector::push_back(BigIntegerView value) {
+    const auto offset = append_digits(value);
+    m_entries.push_back(Entry{offset, value.count(), value.sign()});
 }
 
-BigInteger::BigInteger(const char *num) : m_sign(Sign::POSITIVE), m_data{} {
-    const auto filtered = parse(num);
-    for (int i = filtered.size() - 1; i >= 0; --i) {
-        const auto digit = filtered[i] - '0';
-        push_digit(digit);
+void BigIntegerVector::set(size_t pos, BigIntegerView value) {
+    auto entry = m_entries.at(pos);
+
+    if (value.count() <= entry.size) {
+        std::memmove(m_pool.data() + entry.offset, value.data(),
+                     value.count());
+        m_garbage += entry.size - value.count();
+    } else {
+        m_garbage += entry.size;
+        entry.offset = append_digits(value);
     }
+
+    entry.size = value.count();
+    entry.sign = value.sign();
+    m_entries[pos] = entry;
 }
 
-BigInteger::BigInteger(const string &num) : m_sign(Sign::POSITIVE), m_data{} {
-    const auto filtered = parse(num.c_str());
-    for (int i = filtered.size() - 1; i >= 0; --i) {
-        const auto digit = filtered[i] - '0';
-        push_digit(digit);
-    }
+BigIntegerView BigIntegerVector::operator[](size_t pos) const {
+    const auto &entry = m_entries[pos];
+    return BigIntegerView(entry.sign, m_pool.data() + entry.offset,
+                          entry.size);
 }
 
-BigInteger::BigInteger(const BigInteger &rhs)
-    : m_sign(rhs.m_sign), m_data(rhs.m_data) {}
+void BigIntegerVector::clear() {
+    m_pool.clear();
+    m_entries.clear();
+    m_garbage = 0;
+}
 
-BigInteger::BigInteger(BigInteger &&rhs)
-    : m_sign(rhs.m_sign), m_data(std::move(rhs.m_data)) {}
+void BigIntegerVector::compact() {
+    if (!m_garbage)
+        return;
 
-BigInteger &BigInteger::operator=(const BigInteger &rhs) {
-    if (this == &rhs)
-        return *this;
+    std::pmr::vector<char> pool(m_pool.get_allocator());
+    pool.reserve(m_pool.size() - m_garbage);
 
-    m_data.clear();
-    m_data.resize(rhs.m_data.size());
+    for (auto &entry : m_entries) {
+        const auto *digits = m_pool.data() + entry.offset;
+        entry.offset = pool.size();
+        pool.insert(pool.end(), digits, digits + entry.size);
+    }
 
-    std::copy(rhs.m_data.begin(), rhs.m_data.end(), m_data.begin());
+    m_pool.swap(pool);
+    m_garbage = 0;
+}
 
-    m_sign = rhs.m_sign;
+BigIntegerVector::const_iterator BigIntegerVector::begin() const {
+    return const_iterator(this, 0);
+}
+
+BigIntegerVector::const_iterator BigIntegerVector::end() const {
+    return const_iterator(this, m_entries.size());
+}
+
+template <typename Op> void BigIntegerVector::transform(Op op) {
+    // the results go to a new pool and entry table, swapped in only once op
+    // has succeeded for every element, so a throw leaves the column intact
+    std::pmr::vector<char> pool(m_pool.get_allocator());
+    pool.reserve(m_pool.size() - m_garbage);
+    std::pmr::vector<Entry> entries(m_entries.get_allocator());
+    entries.reserve(m_entries.size());
+
+    // one scratch value carries its capacity from element to element
+    BigInteger value;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        value = (*this)[i];
+        op(value, i);
+
+        const BigIntegerView res = value;
+        entries.push_back({pool.size(), res.count(), res.sign()});
+        pool.insert(pool.end(), res.data(), res.data() + res.count());
+    }
 
+    m_pool.swap(pool);
+    m_entries.swap(entries);
+    m_garbage = 0;
+}
+
+BigIntegerVector &BigIntegerVector::operator+=(BigIntegerView rhs) {
+    BigInteger addend(rhs);
+    transform([&](BigInteger &value, size_t) { value += addend; });
     return *this;
 }
 
-BigInteger &BigInteger::operator=(BigInteger &&rhs) {
+BigIntegerVector &BigIntegerVector::operator+=(const BigIntegerVector &rhs) {
+    if (rhs.size() != size())
+        throw std::invalid_argument("column sizes differ");
+
     if (this == &rhs) {
+        transform([](BigInteger &value, size_t) { value *= 2; });
         return *this;
     }
 
-    m_data = rhs.m_data;
-    rhs.m_data = {};
-
-    m_sign = rhs.m_sign;
+    transform([&](BigInteger &value, size_t i) { value += rhs[i]; });
+    return *this;
+}
 
+BigIntegerVector &BigIntegerVector::operator*=(BigIntegerView rhs) {
+    BigInteger factor(rhs);
+    transform([&](BigInteger &value, size_t) { value *= factor; });
     return *this;
 }
 
-BigInteger::~BigInteger() {
-    // cout << "dtor, see you later\n";
+BigIntegerVector &BigIntegerVector::operator*=(const BigIntegerVector &rhs) {
+    if (rhs.size() != size())
+        throw std::invalid_argument("column sizes differ");
+
+    if (this == &rhs) {
+        transform([](BigInteger &value, size_t) { value *= value; });
+        return *this;
+    }
+
+    transform([&](BigInteger &value, size_t i) { value *= rhs[i]; });
+    return *this;
 }
 
-vector<char> BigInteger::parse(const char *str) {
-    vector<char> res;
-    int len = strlen(str);
-    int iter = 0;
+BigIntegerColumnWriter::BigIntegerColumnWriter(const string &path,
+                                               uint64_t block_size)
+    : m_out(path, std::ios::binary | std::ios::trunc),
+      m_block_size(block_size), m_blob_size(0), m_entries{}, m_blocks{},
+      m_block_min{}, m_block_max{}, m_closed(false) {
+    if (!m_out)
+        throw std::runtime_error("cannot create column file " + path);
+
+    // the header is rewritten with the final sizes on close()
+    const detail::ColumnHeader header{};
+    m_out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
 
-    if (str[0] == '-') {
-        m_sign = Sign::NEGATIVE;
-        iter = 1;
+BigIntegerColumnWriter::~BigIntegerColumnWriter() {
+    try {
+        close();
+    } catch (...) {
+        // destructors must not throw; call close() to see errors
     }
+}
 
-    for (; iter < len; ++iter) {
-        if (str[iter] == '_') {
-            // ignore
-        } else {
-            res.push_back(str[iter]);
+void BigIntegerColumnWriter::append(BigIntegerView value) {
+    if (m_closed)
+        throw std::logic_error("column file already closed");
+
+    detail::ColumnEntry entry{};
+    entry.offset = m_blob_size;
+    entry.size = value.count();
+    entry.sign = value.sign() == Sign::NEGATIVE;
+
+    m_out.write(value.data(), value.count());
+    m_blob_size += value.count();
+
+    if (m_block_size) {
+        const uint64_t index = m_entries.size();
+        if (index % m_block_size == 0) {
+            m_blocks.push_back(detail::ColumnBlock{index, index});
+            m_block_min = value;
+            m_block_max = value;
+        } else if (value < m_block_min) {
+            m_blocks.back().min = index;
+            m_block_min = value;
+        } else if (m_block_max < value) {
+            m_blocks.back().max = index;
+            m_block_max = value;
         }
     }
 
-    return res;
+    m_entries.push_back(entry);
 }
 
-BigInteger BigInteger::operator+(const BigInteger &rhs) const {
-    auto res = *this;
-    res += rhs;
-    return res;
+void BigIntegerColumnWriter::append(const BigIntegerVector &values) {
+    for (auto value : values)
+        append(value);
 }
 
-BigInteger &BigInteger::operator+=(const BigInteger &rhs) {
-    if (this == &rhs) {
-        *this *= 2;
-        return *this;
+void BigIntegerColumnWriter::close() {
+    if (m_closed)
+        return;
+    m_closed = true;
+
+    detail::ColumnHeader header{};
+    std::memcpy(header.magic, detail::COLUMN_MAGIC, sizeof(header.magic));
+    header.version = detail::COLUMN_VERSION;
+    header.flags = m_block_size ? detail::COLUMN_HAS_BLOCKS : 0;
+    header.count = m_entries.size();
+    header.block_size = m_block_size;
+    header.blob_offset = sizeof(header);
+
+    // the entries are read in place, so they start 8-byte aligned
+    const uint64_t end = sizeof(header) + m_blob_size;
+    const uint64_t padding = (8 - end % 8) % 8;
+    const char zeros[8] = {};
+    m_out.write(zeros, padding);
+
+    header.entries_offset = end + padding;
+    m_out.write(reinterpret_cast<const char *>(m_entries.data()),
+                m_entries.size() * sizeof(detail::ColumnEntry));
+
+    header.blocks_offset =
+        header.entries_offset + m_entries.size() * sizeof(detail::ColumnEntry);
+    m_out.write(reinterpret_cast<const char *>(m_blocks.data()),
+                m_blocks.size() * sizeof(detail::ColumnBlock));
+
+    header.file_size =
+        header.blocks_offset + m_blocks.size() * sizeof(detail::ColumnBlock);
+
+    m_out.seekp(0);
+    m_out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    m_out.close();
+
+    if (!m_out)
+        throw std::runtime_error("cannot write column file");
+}
+
+BigIntegerColumnFile::BigIntegerColumnFile(const string &path)
+    : m_base(nullptr), m_size(0), m_buffer{}, m_header(nullptr),
+      m_entries(nullptr), m_blocks(nullptr) {
+#ifdef GH_BIG_INTEGER_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open column file " + path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot map column file " + path);
     }
 
-    if (is_positive() != rhs.is_positive()) {
-        *this -= (rhs * -1);
-        return *this;
+    void *mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        throw std::runtime_error("cannot map column file " + path);
+
+    m_base = static_cast<const char *>(mapped);
+    m_size = info.st_size;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("cannot open column file " + path);
+
+    m_buffer.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+    m_base = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+
+    try {
+        validate();
+    } catch (...) {
+#ifdef GH_BIG_INTEGER_MMAP
+        ::munmap(const_cast<char *>(m_base), m_size);
+#endif
+        throw;
     }
+}
 
-    const auto l_size = this->count();
-    const auto r_size = rhs.count();
+BigIntegerColumnFile::~BigIntegerColumnFile() {
+#ifdef GH_BIG_INTEGER_MMAP
+    ::munmap(const_cast<char *>(m_base), m_size);
+#endif
+}
 
-    int sum = 0;
-    int carry = 0;
-    for (int i = 0; i < std::max(l_size, r_size); ++i) {
-        sum = get_digit(i) + rhs.get_digit(i) + carry;
-        carry = sum / BASE;
-        sum = sum % BASE;
+void BigIntegerColumnFile::validate() {
+    m_header = reinterpret_cast<const detail::ColumnHeader *>(m_base);
+
+    if (m_size < sizeof(detail::ColumnHeader) ||
+        std::memcmp(m_header->magic, detail::COLUMN_MAGIC,
+                    sizeof(m_header->magic)) != 0)
+        throw std::runtime_error("not a column file");
+
+    // the sections are read in place, so every offset is checked against the
+    // mapping before anything is dereferenced; the comparisons are ordered so
+    // none of them can overflow
+    const auto &header = *m_header;
+    if (header.version != detail::COLUMN_VERSION ||
+        header.file_size != m_size ||
+        header.blob_offset < sizeof(detail::ColumnHeader) ||
+        header.entries_offset < header.blob_offset ||
+        header.entries_offset > m_size || header.entries_offset % 8 != 0 ||
+        header.count > (m_size - header.entries_offset) /
+                           sizeof(detail::ColumnEntry) ||
+        header.blocks_offset !=
+            header.entries_offset +
+                header.count * sizeof(detail::ColumnEntry))
+        throw std::runtime_error("corrupt column file");
+
+    m_entries = reinterpret_cast<const detail::ColumnEntry *>(
+        m_base + header.entries_offset);
+    m_blocks = reinterpret_cast<const detail::ColumnBlock *>(
+        m_base + header.blocks_offset);
+
+    if (header.blocks_offset + block_count() * sizeof(detail::ColumnBlock) !=
+        m_size)
+        throw std::runtime_error("corrupt column file");
+
+    // every entry has to be a valid view: digits only, no leading zero and
+    // no negative zero
+    const auto blob_size = header.entries_offset - header.blob_offset;
+    const auto *blob = m_base + header.blob_offset;
+    for (uint64_t i = 0; i < header.count; ++i) {
+        const auto &entry = m_entries[i];
+        if (entry.offset > blob_size ||
+            entry.size > blob_size - entry.offset ||
+            entry.size > uint32_t(std::numeric_limits<int>::max()) ||
+            entry.sign > 1 || (entry.sign && !entry.size))
+            throw std::runtime_error("corrupt column file");
+
+        const auto *digits = blob + entry.offset;
+        if ((entry.size && digits[entry.size - 1] == '0') ||
+            !std::all_of(digits, digits + entry.size, [](char digit) {
+                return digit >= '0' && digit <= '9';
+            }))
+            throw std::runtime_error("corrupt column file");
+    }
 
-        if (i < l_size) {
-            change_digit(i, sum);
-        } else {
-            push_digit(sum);
-        }
+    for (size_t i = 0; i < block_count(); ++i) {
+        if (m_blocks[i].min >= header.count ||
+            m_blocks[i].max >= header.count)
+            throw std::runtime_error("corrupt column file");
     }
+}
 
-    if (carry)
-        push_digit(carry);
+size_t BigIntegerColumnFile::size() const { return m_header->count; }
 
-    return *this;
+BigIntegerView BigIntegerColumnFile::operator[](size_t pos) const {
+    const auto &entry = m_entries[pos];
+    return BigIntegerView(entry.sign ? Sign::NEGATIVE : Sign::POSITIVE,
+                          m_base + m_header->blob_offset + entry.offset,
+                          entry.size);
 }
 
-BigInteger BigInteger::operator-(const BigInteger &rhs) const {
-    auto res = *this;
-    res -= rhs;
-    return res;
+size_t BigIntegerColumnFile::block_size() const {
+    return (m_header->flags & detail::COLUMN_HAS_BLOCKS)
+               ? m_header->block_size
+               : 0;
 }
 
-BigInteger &BigInteger::operator-=(const BigInteger &rhs) {
-    if (this == &rhs) {
-        *this = 0;
-        return *this;
-    }
+size_t BigIntegerColumnFile::block_count() const {
+    const auto per_block = block_size();
+    if (!per_block)
+        return 0;
 
-    if (is_negative() != rhs.is_negative()) {
-        *this += (rhs * -1);
-        return *this;
-    }
+    return m_header->count / per_block + (m_header->count % per_block != 0);
+}
 
-    if (is_positive() && (*this) < rhs || is_negative() && (*this) > rhs) {
-        *this = rhs - *this;
-        if (is_positive())
-            this->m_sign = Sign::NEGATIVE;
-        else
-            this->m_sign = Sign::POSITIVE;
+BigIntegerView BigIntegerColumnFile::block_min(size_t block) const {
+    if (block >= block_count())
+        throw std::out_of_range("column file block out of range");
 
-        return *this;
-    }
+    return (*this)[m_blocks[block].min];
+}
 
-    int diff = 0;
-    int borrow = 0;
+BigIntegerView BigIntegerColumnFile::block_max(size_t block) const {
+    if (block >= block_count())
+        throw std::out_of_range("column file block out of range");
 
-    for (int i = 0; i < count(); ++i) {
-        diff = get_digit(i) - rhs.get_digit(i) - borrow;
-        borrow = 0;
-        if (diff < 0) {
-            diff += 10;
-            borrow = 1;
-        }
+    return (*this)[m_blocks[block].max];
+}
 
-        change_digit(i, diff);
-    }
-    normalize();
+BigIntegerVector BigIntegerColumnFile::to_vector() const {
+    BigIntegerVector res;
+    res.reserve(size(), m_header->entries_offset - m_header->blob_offset);
 
-    return *this;
-}
+    for (size_t i = 0; i < size(); ++i)
+        res.push_back((*this)[i]);
 
-BigInteger BigInteger::operator*(const BigInteger &rhs) const {
-    auto res = *this;
-    res *= rhs;
     return res;
 }
 
-BigInteger &BigInteger::operator*=(const BigInteger &rhs) {
-    bool negate_it = false;
-    if (this->m_sign != rhs.m_sign)
-        negate_it = true;
-
-    BigInteger lhs = *this;
-    BigInteger sum = 0;
-    const auto len = rhs.count();
+namespace detail {
 
-    for (int i = 0; i < len; ++i) {
-        sum += lhs * rhs.get_digit(i);
-        lhs *= 10;
+void put_varint(vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value | 0x80));
+        value >>= 7;
     }
+    out.push_back(uint8_t(value));
+}
 
-    *this = sum;
+uint64_t get_varint(const uint8_t *&pos, const uint8_t *end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos == end)
+            throw std::runtime_error("truncated delta sequence");
 
-    if (negate_it)
-        this->m_sign = Sign::NEGATIVE;
+        const auto byte = *pos++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
 
-    return *this;
+    throw std::runtime_error("corrupt delta sequence");
 }
 
-BigInteger BigInteger::operator*(const int &num) const {
-    auto res = *this;
-    res *= num;
-    return res;
+// tag bit 1: raw value with the sign and digit count in the varint, then the
+// digits packed two per byte
+void put_raw(vector<uint8_t> &out, BigIntegerView value) {
+    const uint64_t negative = value.sign() == Sign::NEGATIVE;
+    put_varint(out, (uint64_t(value.count()) << 2) | (negative << 1) | 1);
+
+    for (int i = 0; i < value.count(); i += 2)
+        out.push_back(uint8_t(value.get_digit(i) | value.get_digit(i + 1) << 4));
 }
 
-BigInteger &BigInteger::operator*=(const int &num) {
-    if (num == 0) {
-        *this = 0;
-        return *this;
+void get_raw(uint64_t tag, const uint8_t *&pos, const uint8_t *end,
+             BigInteger &out) {
+    const auto count = tag >> 2;
+    if (count > uint64_t(std::numeric_limits<int>::max()))
+        throw std::runtime_error("corrupt delta sequence");
+    if (uint64_t(end - pos) < (count + 1) / 2)
+        throw std::runtime_error("truncated delta sequence");
+
+    ScratchStack::Marker marker;
+    auto *digits = ScratchStack::local().alloc<char>(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        const auto nibble = (pos[i / 2] >> (i % 2 * 4)) & 0xf;
+        if (nibble > 9)
+            throw std::runtime_error("corrupt delta sequence");
+        digits[i] = char('0' + nibble);
     }
+    pos += (count + 1) / 2;
 
-    if (num == 1)
-        return *this;
+    // the encoder only writes normalized values
+    if (count ? digits[count - 1] == '0' : (tag & 2) != 0)
+        throw std::runtime_error("corrupt delta sequence");
 
-    if (BASE < num || num < 0)
-        return *this *= BigInteger(num);
+    out = BigIntegerView((tag & 2) ? Sign::NEGATIVE : Sign::POSITIVE, digits,
+                         count);
+}
 
-    bool negate_it = false;
-    if (this->is_negative() && num > 0)
-        negate_it = true;
+} // namespace detail
 
-    // multiply a single positive digit to BigInteger
-    int product = 0;
-    int carry = 0;
-    int len = count();
-    for (int i = 0; i < len; ++i) {
-        product = num * get_digit(i) + carry;
-        carry = product / BASE;
-        this->change_digit(i, product % BASE);
+BigIntegerDeltaEncoder::BigIntegerDeltaEncoder(size_t block_size)
+    : m_block_size(block_size ? block_size : 1), m_count(0), m_body{},
+      m_blocks{}, m_prev{}, m_delta{} {}
+
+void BigIntegerDeltaEncoder::append(BigIntegerView value) {
+    if (m_count % m_block_size == 0) {
+        m_blocks.push_back(m_body.size());
+        detail::put_raw(m_body, value);
+        m_prev = value;
+        ++m_count;
+        return;
     }
 
-    if (carry)
-        push_digit(carry);
+    m_delta = value;
+    m_delta -= m_prev;
+    m_prev = value;
+    ++m_count;
 
-    if (negate_it)
-        this->m_sign = Sign::NEGATIVE;
+    // up to 18 digits the zigzag value stays below 2^63, leaving the tag bit
+    const BigIntegerView delta = m_delta;
+    if (delta.count() > 18) {
+        detail::put_raw(m_body, value);
+        return;
+    }
 
-    return *this;
-}
+    uint64_t magnitude = 0;
+    for (auto i = delta.count() - 1; i >= 0; --i)
+        magnitude = magnitude * BASE + delta.get_digit(i);
 
-bool operator==(const BigInteger &lhs, const BigInteger &rhs) {
-    return lhs.equal(rhs);
+    const auto zigzag = delta.sign() == Sign::NEGATIVE ? magnitude * 2 - 1
+                                                       : magnitude * 2;
+    detail::put_varint(m_body, zigzag << 1);
 }
 
-bool operator!=(const BigInteger &lhs, const BigInteger &rhs) {
-    return !(lhs == rhs);
-}
+size_t BigIntegerDeltaEncoder::size() const { return m_count; }
 
-bool operator<(const BigInteger &lhs, const BigInteger &rhs) {
-    return lhs.less_than(rhs);
+vector<uint8_t> BigIntegerDeltaEncoder::encode() const {
+    vector<uint8_t> out;
+    detail::put_varint(out, m_count);
+    detail::put_varint(out, m_block_size);
+
+    out.reserve(out.size() + m_blocks.size() * 8 + m_body.size());
+    for (const auto offset : m_blocks) {
+        uint8_t bytes[8];
+        std::memcpy(bytes, &offset, sizeof(bytes));
+        out.insert(out.end(), bytes, bytes + sizeof(bytes));
+    }
+
+    out.insert(out.end(), m_body.begin(), m_body.end());
+    return out;
 }
 
-bool operator<=(const BigInteger &lhs, const BigInteger &rhs) {
-    return (lhs == rhs) || (lhs < rhs);
+BigIntegerDeltaDecoder::BigIntegerDeltaDecoder(const uint8_t *data,
+                                               size_t size)
+    : m_data(data), m_end(data + size), m_count(0), m_block_size(0),
+      m_block_count(0), m_index(nullptr), m_body(nullptr) {
+    const uint8_t *pos = m_data;
+    m_count = detail::get_varint(pos, m_end);
+    m_block_size = detail::get_varint(pos, m_end);
+
+    if (!m_block_size)
+        throw std::runtime_error("corrupt delta sequence");
+
+    m_block_count = m_count / m_block_size + (m_count % m_block_size != 0);
+    if (uint64_t(m_end - pos) / 8 < m_block_count)
+        throw std::runtime_error("truncated delta sequence");
+
+    m_index = pos;
+    m_body = pos + m_block_count * 8;
 }
 
-bool operator>(const BigInteger &lhs, const BigInteger &rhs) {
-    return rhs < lhs;
+size_t BigIntegerDeltaDecoder::size() const { return m_count; }
+
+size_t BigIntegerDeltaDecoder::block_count() const { return m_block_count; }
+
+template <typename Visit>
+void BigIntegerDeltaDecoder::walk_block(size_t block, size_t last,
+                                        Visit visit) const {
+    uint64_t offset = 0;
+    std::memcpy(&offset, m_index + block * 8, sizeof(offset));
+    if (offset > uint64_t(m_end - m_body))
+        throw std::runtime_error("corrupt delta sequence");
+
+    const uint8_t *pos = m_body + offset;
+    BigInteger value;
+
+    for (size_t i = 0; i <= last; ++i) {
+        const auto tag = detail::get_varint(pos, m_end);
+
+        if (i == 0 || (tag & 1)) {
+            if (!(tag & 1))
+                throw std::runtime_error("corrupt delta sequence");
+            detail::get_raw(tag, pos, m_end, value);
+        } else {
+            const auto zigzag = tag >> 1;
+            auto magnitude = (zigzag + 1) / 2;
+
+            // spell the delta out in digits so no BigInteger is built for it
+            char digits[20];
+            int count = 0;
+            for (; magnitude; magnitude /= BASE)
+                digits[count++] = char('0' + magnitude % BASE);
+
+            value += BigIntegerView(zigzag & 1 ? Sign::NEGATIVE
+                                               : Sign::POSITIVE,
+                                    digits, count);
+        }
+
+        visit(static_cast<const BigInteger &>(value));
+    }
 }
 
-bool operator>=(const BigInteger &lhs, const BigInteger &rhs) {
-    return (lhs == rhs) || (rhs > rhs);
+BigInteger BigIntegerDeltaDecoder::operator[](size_t pos) const {
+    if (pos >= m_count)
+        throw std::out_of_range("delta sequence index out of range");
+
+    BigInteger res;
+    walk_block(pos / m_block_size, pos % m_block_size,
+               [&](const BigInteger &value) { res = value; });
+    return res;
 }
 
-int BigInteger::count() const { return this->m_data.size(); }
+void BigIntegerDeltaDecoder::decode_block(size_t block,
+                                          BigIntegerVector &out) const {
+    if (block >= m_block_count)
+        throw std::out_of_range("delta sequence block out of range");
 
-void BigInteger::push_digit(const int &val) {
-    this->m_data.push_back(char(val + '0'));
+    const auto first = block * m_block_size;
+    const auto last = std::min(m_count, first + m_block_size) - 1;
+
+    walk_block(block, last - first,
+               [&](const BigInteger &value) { out.push_back(value); });
 }
 
-void BigInteger::change_digit(const int &pos, const int &val) {
-    int len = count();
-    if (pos >= 0 && pos < len) {
-        this->m_data[pos] = char(val + '0');
-        return;
-    }
+BigIntegerVector BigIntegerDeltaDecoder::decode() const {
+    BigIntegerVector res;
+    for (size_t block = 0; block < m_block_count; ++block)
+        decode_block(block, res);
 
-    throw "Invalid position : " + std::to_string(pos);
+    return res;
 }
 
-int BigInteger::get_digit(const int &pos) const {
-    const auto len = count();
+namespace detail {
 
-    if (pos >= 0 && pos < len)
-        return (m_data[pos] - '0');
+// below this many keys a radix pass costs more than comparing
+const size_t RADIX_CUTOFF = 32;
+
+// buckets at least this large go to the shared queue, where any worker may
+// pick them up
+const size_t PARALLEL_CUTOFF = 1 << 16;
+
+int compare_keys(const SortKey &lhs, const SortKey &rhs, int depth) {
+    for (auto i = lhs.count - 1 - depth; i >= 0; --i) {
+        if (lhs.digits[i] != rhs.digits[i])
+            return lhs.digits[i] < rhs.digits[i] ? -1 : 1;
+    }
 
     return 0;
 }
 
-string BigInteger::to_string() const {
-    string res = "";
-    if (this->is_negative())
-        res.push_back('-');
+/**
+ * @brief Keys that share their sign and digit count and agree on their top
+ * `depth` digits.
+ */
+struct RadixBucket {
+    size_t lo;
+    size_t n;
+    int depth;
+};
 
-    int len = count();
+/**
+ * @brief The buckets the worker threads of one sort_keys call share.
+ */
+class RadixQueue {
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_ready;
+    vector<RadixBucket> m_buckets;
+    size_t m_busy = 0;
 
-    for (auto i = len - 1; i >= 0; --i) {
-        const auto digit = char(get_digit(i) + '0');
-        res.push_back(digit);
+  public:
+    void push(const RadixBucket &bucket) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buckets.push_back(bucket);
+        }
+        m_ready.notify_one();
     }
 
-    return res.size() ? res : "0";
-}
+    /**
+     * @brief Wait for a bucket to sort; call done() once it is sorted.
+     * @param bucket Receives the bucket.
+     * @return False once the queue is empty and no worker can add to it.
+     */
+    bool pop(RadixBucket &bucket) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_ready.wait(lock, [&] { return !m_buckets.empty() || !m_busy; });
+        if (m_buckets.empty())
+            return false;
 
-void BigInteger::normalize() {
-    const auto len = count();
-    for (int i = len - 1; i >= 0; --i) {
-        if (get_digit(i) != 0)
-            break;
-        else {
-            if (m_data.size())
-                m_data.pop_back();
+        bucket = m_buckets.back();
+        m_buckets.pop_back();
+        ++m_busy;
+        return true;
+    }
+
+    void done() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!--m_busy && m_buckets.empty())
+            m_ready.notify_all();
+    }
+};
+
+// sub-buckets go on an explicit stack, so long shared prefixes cannot
+// overflow the call stack; negative keys are sorted by descending magnitude
+void radix_sort_bucket(SortKey *keys, SortKey *tmp, RadixBucket root,
+                       RadixQueue &queue) {
+    vector<RadixBucket> pending{root};
+    while (!pending.empty()) {
+        const auto bucket = pending.back();
+        pending.pop_back();
+
+        auto *first = keys + bucket.lo;
+        if (bucket.n < 2 || bucket.depth >= first->count)
+            continue;
+
+        const auto negative = first->negative;
+        if (bucket.n < RADIX_CUTOFF) {
+            std::sort(first, first + bucket.n,
+                      [&](const SortKey &lhs, const SortKey &rhs) {
+                          const auto order =
+                              compare_keys(lhs, rhs, bucket.depth);
+                          return negative ? order > 0 : order < 0;
+                      });
+            continue;
+        }
+
+        const auto pos = first->count - 1 - bucket.depth;
+        const auto slot = [&](const SortKey &key) {
+            const auto digit = key.digits[pos] - '0';
+            return negative ? BASE - 1 - digit : digit;
+        };
+
+        size_t counts[BASE + 1] = {};
+        for (size_t i = 0; i < bucket.n; ++i)
+            ++counts[slot(first[i]) + 1];
+
+        // a digit every key shares moves nothing
+        if (counts[slot(*first) + 1] == bucket.n) {
+            pending.push_back({bucket.lo, bucket.n, bucket.depth + 1});
+            continue;
+        }
+
+        for (int d = 0; d < BASE; ++d)
+            counts[d + 1] += counts[d];
+
+        size_t next[BASE];
+        std::copy(counts, counts + BASE, next);
+        auto *scratch = tmp + bucket.lo;
+        for (size_t i = 0; i < bucket.n; ++i)
+            scratch[next[slot(first[i])]++] = first[i];
+        std::copy(scratch, scratch + bucket.n, first);
+
+        for (int d = 0; d < BASE; ++d) {
+            const RadixBucket sub{bucket.lo + counts[d],
+                                  counts[d + 1] - counts[d], bucket.depth + 1};
+            if (sub.n >= PARALLEL_CUTOFF)
+                queue.push(sub);
+            else
+                pending.push_back(sub);
         }
     }
 }
 
-bool BigInteger::equal(const BigInteger &rhs) const {
-    const auto l_size = this->count();
-    const auto r_size = rhs.count();
-    const auto l_sign = this->m_sign;
-    const auto r_sign = rhs.m_sign;
+void sort_keys(vector<SortKey> &keys) {
+    // order by sign and length first: more digits means a larger magnitude,
+    // which for negative values means a smaller value
+    std::sort(keys.begin(), keys.end(),
+              [](const SortKey &lhs, const SortKey &rhs) {
+                  if (lhs.negative != rhs.negative)
+                      return lhs.negative;
+                  return lhs.negative ? lhs.count > rhs.count
+                                      : lhs.count < rhs.count;
+              });
+
+    vector<SortKey> tmp(keys.size());
+    RadixQueue queue;
+    for (size_t lo = 0, hi = 0; lo < keys.size(); lo = hi) {
+        hi = lo + 1;
+        while (hi < keys.size() && keys[hi].negative == keys[lo].negative &&
+               keys[hi].count == keys[lo].count)
+            ++hi;
+
+        queue.push({lo, hi - lo, 0});
+    }
 
-    if ((l_size != r_size) || (l_sign != r_sign))
-        return false;
+    const auto work = [&] {
+        RadixBucket bucket;
+        while (queue.pop(bucket)) {
+            radix_sort_bucket(keys.data(), tmp.data(), bucket, queue);
+            queue.done();
+        }
+    };
+
+    // at most one thread per core, and none when no bucket can be large
+    // enough to share
+    vector<std::thread> workers;
+    if (keys.size() >= PARALLEL_CUTOFF) {
+        const auto cores = std::max(1U, std::thread::hardware_concurrency());
+        try {
+            for (unsigned i = 1; i < cores; ++i)
+                workers.emplace_back(work);
+        } catch (const std::system_error &) {
+            // fewer threads sort the same buckets
+        }
+    }
 
-    for (auto i = 0; i < l_size; ++i) {
-        if (this->get_digit(i) != rhs.get_digit(i))
-            return false;
+    work();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+} // namespace detail
+
+namespace detail {
+
+std::string_view split_decimal(std::string_view text, bool &negative) {
+    negative = !text.empty() && text[0] == '-';
+    text.remove_prefix(negative);
+
+    // eight characters per step: a digit has high nibble 3 and keeps it when
+    // 6 is added; a carry out of a byte only follows a byte that fails anyway
+    const uint64_t high = 0xf0f0f0f0f0f0f0f0ULL;
+    const uint64_t threes = 0x3030303030303030ULL;
+    bool invalid = text.empty();
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, sizeof(word));
+        invalid |= (word & high) != threes ||
+                   ((word + 0x0606060606060606ULL) & high) != threes;
     }
+    for (; i < text.size(); ++i)
+        invalid |= static_cast<unsigned char>(text[i] - '0') > 9;
+    if (invalid)
+        throw std::invalid_argument("not a decimal integer");
+
+    const auto first = text.find_first_not_of('0');
+    text.remove_prefix(first == std::string_view::npos ? text.size() : first);
+    negative = negative && !text.empty();
 
-    return true;
+    return text;
 }
 
-bool BigInteger::less_than(const BigInteger &rhs) const {
-    const auto l_size = this->count();
-    const auto r_size = rhs.count();
-    const auto l_sign = this->m_sign;
-    const auto r_sign = rhs.m_sign;
+} // namespace detail
 
-    if (l_sign != r_sign)
-        return this->is_negative();
+int compare_decimal_strings(std::string_view lhs, std::string_view rhs) {
+    bool l_negative, r_negative;
+    lhs = detail::split_decimal(lhs, l_negative);
+    rhs = detail::split_decimal(rhs, r_negative);
 
-    if (l_size != r_size)
-        return (l_size < r_size && this->is_positive()) ||
-               (l_size > r_size && this->is_negative());
+    if (l_negative != r_negative)
+        return l_negative ? -1 : 1;
 
-    for (auto i = l_size - 1; i >= 0; --i) {
-        if (this->get_digit(i) < rhs.get_digit(i))
-            return this->is_positive();
-        if (this->get_digit(i) > rhs.get_digit(i))
-            return this->is_negative();
-    }
+    // most significant first, so equal lengths compare like memcmp
+    int order = lhs.size() != rhs.size() ? (lhs.size() < rhs.size() ? -1 : 1)
+                                         : lhs.compare(rhs);
+    order = order < 0 ? -1 : order > 0;
 
-    return false;
+    return l_negative ? -order : order;
 }
 
-bool BigInteger::is_positive() const { return this->m_sign == Sign::POSITIVE; }
+void add_decimal_strings(std::string_view lhs, std::string_view rhs,
+                         string &out) {
+    bool l_negative, r_negative;
+    lhs = detail::split_decimal(lhs, l_negative);
+    rhs = detail::split_decimal(rhs, r_negative);
+
+    // the larger magnitude goes first, and decides the sign of a difference
+    const auto subtract = l_negative != r_negative;
+    if (lhs.size() < rhs.size() ||
+        (lhs.size() == rhs.size() && subtract && lhs < rhs)) {
+        std::swap(lhs, rhs);
+        std::swap(l_negative, r_negative);
+    }
 
-bool BigInteger::is_negative() const { return this->m_sign == Sign::NEGATIVE; }
+    const int l_size = lhs.size();
+    const int r_size = rhs.size();
+    if (auto *budget = ComputeBudget::current())
+        budget->charge(l_size);
+
+    // the kernels carry toward higher indices, so the digits are reversed
+    // into scratch, least significant first, and back once added
+    ScratchStack::Marker marker;
+    auto &scratch = ScratchStack::local();
+    auto *sum = scratch.alloc<char>(l_size + 1);
+    auto *low = scratch.alloc<char>(r_size);
+    const auto &kernels = detail::kernels();
+    kernels.reverse(sum, lhs.data(), l_size);
+    kernels.reverse(low, rhs.data(), r_size);
+
+    auto carry = subtract ? kernels.sub_n(sum, sum, low, r_size, 0)
+                          : kernels.add_n(sum, sum, low, r_size, 0);
+    // past the shorter operand only the carry or borrow is left
+    for (auto i = r_size; carry && i < l_size; ++i) {
+        if (subtract) {
+            carry = sum[i] == '0';
+            sum[i] = carry ? '9' : char(sum[i] - 1);
+        } else {
+            carry = sum[i] == '9';
+            sum[i] = carry ? '0' : char(sum[i] + 1);
+        }
+    }
 
-ostream &operator<<(ostream &os, const BigInteger &rhs) {
-    os << rhs.to_string();
-    return os;
-}
+    auto size = l_size;
+    if (carry)
+        sum[size++] = '1';
+    while (size && sum[size - 1] == '0')
+        --size;
 
-istream &operator>>(istream &is, BigInteger &rhs) {
-    string str;
-    is >> str;
+    if (!size) {
+        out.assign("0");
+        return;
+    }
 
-    rhs = BigInteger(str);
-    return is;
+    out.resize(size + l_negative);
+    if (l_negative)
+        out[0] = '-';
+    kernels.reverse(&out[l_negative], sum, size);
 }
 
 } // namespace gh
 
+namespace std {
+
+/**
+ * @brief Hash support for BigInteger, e.g. as an unordered_map key.
+ */
+template <> struct hash<gh::BigInteger> {
+    size_t operator()(const gh::BigInteger &value) const {
+        return value.hash();
+    }
+};
+
+/**
+ * @brief Hash support for BigIntegerView, consistent with BigInteger.
+ */
+template <> struct hash<gh::BigIntegerView> {
+    size_t operator()(gh::BigIntegerView value) const { return value.hash(); }
+};
+
+/**
+ * @brief Hash support for SharedBigInteger, consistent with BigInteger.
+ */
+template <> struct hash<gh::SharedBigInteger> {
+    size_t operator()(const gh::SharedBigInteger &value) const {
+        return value.hash();
+    }
+};
+
+} // namespace std
+
 #endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Checks ComputeBudget limits, deadlines and nesting, and that an operation
+// throwing BudgetExceeded leaves its target unchanged.
+//
+//     g++ -std=c++17 -O2 -pthread tests/budget.cpp -o budget && ./budget
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+string text(const BigInteger &value) {
+    ostringstream out;
+    out << value;
+    return out.str();
+}
+
+void check_limit() {
+    ComputeBudget budget(100ULL);
+    budget.charge(60);
+    budget.charge(40);
+    check(budget.used() == 100 && !budget.exceeded(), "limit charges");
+
+    bool threw = false;
+    try {
+        budget.charge(1);
+    } catch (const BudgetExceeded &) {
+        threw = true;
+    }
+    check(threw && budget.exceeded() && budget.used() == 100,
+          "limit exceeded");
+
+    // once exceeded, even a free charge throws
+    threw = false;
+    try {
+        budget.charge(0);
+    } catch (const BudgetExceeded &) {
+        threw = true;
+    }
+    check(threw, "limit stays exceeded");
+}
+
+void check_deadline() {
+    ComputeBudget budget(std::chrono::milliseconds(1));
+    budget.charge(1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    bool threw = false;
+    try {
+        budget.charge(1);
+    } catch (const BudgetExceeded &) {
+        threw = true;
+    }
+    check(threw && budget.exceeded(), "deadline exceeded");
+}
+
+void check_nesting() {
+    check(ComputeBudget::current() == nullptr, "no budget outside");
+
+    ComputeBudget outer(100ULL);
+    {
+        // the inner budget is generous, but the outer one still applies
+        ComputeBudget inner(1000ULL);
+        check(ComputeBudget::current() == &inner, "inner budget active");
+        inner.charge(80);
+        check(inner.used() == 80 && outer.used() == 80, "nested charges");
+
+        bool threw = false;
+        try {
+            inner.charge(30);
+        } catch (const BudgetExceeded &) {
+            threw = true;
+        }
+        check(threw && outer.exceeded() && !inner.exceeded(),
+              "outer limit wins");
+        check(inner.used() == 80 && outer.used() == 80,
+              "nothing charged on failure");
+    }
+    check(ComputeBudget::current() == &outer, "outer budget reinstated");
+
+    // the same through the operators
+    ComputeBudget tight(10ULL);
+    bool threw = false;
+    BigInteger x(string(50, '7'));
+    try {
+        ComputeBudget loose(1000000ULL);
+        x *= x;
+    } catch (const BudgetExceeded &) {
+        threw = true;
+    }
+    check(threw && text(x) == string(50, '7'), "operator under nested budget");
+}
+
+// run op under ever larger limits: every attempt either throws with the
+// target unchanged or gives the unbudgeted result
+template <typename Op>
+void check_rollback(const string &name, const BigInteger &start, Op op) {
+    BigInteger expected(start);
+    op(expected);
+
+    for (unsigned long long limit = 0;; limit += 1 + limit / 32) {
+        BigInteger x(start);
+        try {
+            ComputeBudget budget(limit);
+            op(x);
+        } catch (const BudgetExceeded &) {
+            check(text(x) == text(start),
+                  name + " changed at limit " + to_string(limit));
+            continue;
+        }
+
+        check(text(x) == text(expected), name + " result");
+        return;
+    }
+}
+
+void check_rollbacks() {
+    const BigInteger sevens(string(40, '7'));
+    const BigInteger nines(string(50, '9'));
+    const BigInteger big("123456789012345678901234567890");
+
+    check_rollback("*= int", BigInteger("123456"),
+                   [](BigInteger &x) { x *= -5; });
+    check_rollback("*= small lhs", BigInteger("12"),
+                   [&](BigInteger &x) { x *= sevens; });
+    check_rollback("+= int across zero", BigInteger("-3"),
+                   [](BigInteger &x) { x += 5; });
+    check_rollback("-= int", big, [](BigInteger &x) { x -= -99; });
+    check_rollback("/= negative int", BigInteger("123456"),
+                   [](BigInteger &x) { x /= -5; });
+    check_rollback("*= power of ten", big, [](BigInteger &x) {
+        x *= BigInteger("-1" + string(30, '0'));
+    });
+    check_rollback("*= big", big, [&](BigInteger &x) { x *= nines; });
+    check_rollback("+= big", big, [&](BigInteger &x) { x += nines; });
+    check_rollback("-= big", big, [&](BigInteger &x) { x -= nines; });
+    check_rollback("mul_mod_pow2", nines,
+                   [&](BigInteger &x) { x.mul_mod_pow2(nines, 100); });
+    check_rollback("mul_mod_pow10", nines,
+                   [&](BigInteger &x) { x.mul_mod_pow10(sevens, 60); });
+    check_rollback("mul_pow10", big, [](BigInteger &x) { x.mul_pow10(20); });
+}
+
+} // namespace
+
+int main() {
+    check_limit();
+    check_deadline();
+    check_nesting();
+    check_rollbacks();
+
+    return finish();
+}
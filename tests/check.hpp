@@ -0,0 +1,78 @@
+// Scaffolding shared by the test programs under tests/: a failure counter,
+// a seeded generator and a loop over the kernel tiers.
+
+#ifndef BIG_INTEGER_TESTS_CHECK_HPP
+#define BIG_INTEGER_TESTS_CHECK_HPP
+
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "../BigInteger.hpp"
+
+namespace tests {
+
+inline int failures = 0;
+
+/**
+ * @brief Record a failed check and print what it was.
+ * @param ok Whether the check passed.
+ * @param what A description of the check.
+ */
+inline void check(bool ok, const std::string &what) {
+    if (!ok) {
+        ++failures;
+        std::cout << "FAIL: " << what << '\n';
+    }
+}
+
+/**
+ * @brief The generator every test draws from; seeded, so a failure repeats.
+ */
+inline std::mt19937_64 rng(20261018);
+
+/**
+ * @brief Random digits, least significant first.
+ * @param n The number of digits.
+ * @param kind 0 for random digits, 1 for all nines and 2 for all zeros, the
+ * worst cases for carries and borrows.
+ * @return The digits as characters.
+ */
+inline std::string random_digits(int n, int kind) {
+    std::string digits(n, '0');
+    for (auto &digit : digits)
+        digit = kind == 1 ? '9' : kind == 2 ? '0' : char('0' + rng() % 10);
+
+    return digits;
+}
+
+/**
+ * @brief Run a body once for every kernel tier the CPU supports, with that
+ * tier active.
+ * @param body Called with the name of the tier.
+ */
+template <typename Body> void for_each_tier(Body body) {
+    for (const char *tier : {"scalar", "sse2", "avx2", "avx512"}) {
+        // a tier the CPU lacks falls back to a lower one, already covered
+        if (gh::set_kernel_tier(tier) != tier) {
+            std::cout << "skip: " << tier << '\n';
+            continue;
+        }
+
+        std::cout << gh::active_kernels() << '\n';
+        body(std::string(tier));
+    }
+}
+
+/**
+ * @brief Print the outcome.
+ * @return The exit code for main: 0 if every check passed, 1 otherwise.
+ */
+inline int finish() {
+    std::cout << (failures ? "FAILED" : "ok") << '\n';
+    return failures != 0;
+}
+
+} // namespace tests
+
+#endif
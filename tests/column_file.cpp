@@ -0,0 +1,167 @@
+// Checks that column files round trip and that truncated or corrupt files
+// are rejected when opened, before any value is read in place.
+//
+//     g++ -std=c++17 -O2 -pthread tests/column_file.cpp -o column_file
+//     ./column_file
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+const string path =
+    (std::filesystem::temp_directory_path() / "gh_column_file_test.bin")
+        .string();
+
+vector<BigInteger> sample_values() {
+    vector<BigInteger> values;
+    for (int i = 0; i < 10; ++i) {
+        auto digits = random_digits(1 + int(rng() % 40), 0);
+        digits.back() = char('1' + rng() % 9);
+        const string sign = i % 3 ? "" : "-";
+        values.emplace_back(sign + string(digits.rbegin(), digits.rend()));
+    }
+    values.emplace_back(0);
+
+    return values;
+}
+
+vector<char> write_file(const vector<BigInteger> &values) {
+    {
+        BigIntegerColumnWriter writer(path, 4);
+        for (const auto &value : values)
+            writer.append(value);
+    }
+
+    ifstream in(path, std::ios::binary);
+    return vector<char>(std::istreambuf_iterator<char>(in),
+                        std::istreambuf_iterator<char>());
+}
+
+void put_file(const vector<char> &bytes) {
+    ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+bool rejected(const vector<char> &bytes) {
+    put_file(bytes);
+    try {
+        BigIntegerColumnFile file(path);
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+
+    return false;
+}
+
+void check_round_trip(const vector<BigInteger> &values) {
+    write_file(values);
+    BigIntegerColumnFile file(path);
+
+    check(file.size() == values.size(), "round trip size");
+    for (size_t i = 0; i < values.size(); ++i)
+        check(BigInteger(file[i]) == values[i], "round trip value");
+
+    check(file.block_count() == 3, "block count");
+    bool threw = false;
+    try {
+        file.block_min(3);
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    check(threw, "block_min out of range");
+
+    threw = false;
+    try {
+        file.block_max(7);
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    check(threw, "block_max out of range");
+}
+
+void check_truncated(const vector<BigInteger> &values) {
+    const auto bytes = write_file(values);
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        check(rejected(vector<char>(bytes.begin(), bytes.begin() + size)),
+              "truncated to " + to_string(size));
+    }
+}
+
+void check_corrupt(const vector<BigInteger> &values) {
+    using detail::ColumnBlock;
+    using detail::ColumnEntry;
+    using detail::ColumnHeader;
+    using Corrupt = std::function<void(char *, ColumnHeader &)>;
+
+    const auto entry = [](char *base, ColumnHeader &header, size_t i) {
+        return reinterpret_cast<ColumnEntry *>(base + header.entries_offset) +
+               i;
+    };
+
+    const vector<pair<string, Corrupt>> cases = {
+        {"magic", [](char *, ColumnHeader &h) { h.magic[0] = 'X'; }},
+        {"version", [](char *, ColumnHeader &h) { ++h.version; }},
+        {"count", [](char *, ColumnHeader &h) { h.count = 1ULL << 62; }},
+        {"block size", [](char *, ColumnHeader &h) { h.block_size = ~0ULL; }},
+        {"blob offset",
+         [](char *, ColumnHeader &h) { h.blob_offset = 1ULL << 40; }},
+        {"entries offset",
+         [](char *, ColumnHeader &h) { h.entries_offset += 8; }},
+        {"entry offset",
+         [&](char *b, ColumnHeader &h) { entry(b, h, 0)->offset = 1ULL << 40; }},
+        {"entry size",
+         [&](char *b, ColumnHeader &h) { entry(b, h, 9)->size += 1000; }},
+        {"sign byte", [&](char *b, ColumnHeader &h) { entry(b, h, 1)->sign = 2; }},
+        {"negative zero",
+         [&](char *b, ColumnHeader &h) { entry(b, h, 10)->sign = 1; }},
+        {"non-digit",
+         [&](char *b, ColumnHeader &h) {
+             b[h.blob_offset + entry(b, h, 2)->offset] = 'x';
+         }},
+        {"leading zero",
+         [&](char *b, ColumnHeader &h) {
+             const auto *e = entry(b, h, 3);
+             b[h.blob_offset + e->offset + e->size - 1] = '0';
+         }},
+        {"block index",
+         [](char *b, ColumnHeader &h) {
+             reinterpret_cast<ColumnBlock *>(b + h.blocks_offset)[1].max = 11;
+         }},
+    };
+
+    const auto bytes = write_file(values);
+    check(!rejected(bytes), "untouched file opens");
+    for (const auto &corrupt : cases) {
+        auto copy = bytes;
+        ColumnHeader header;
+        std::memcpy(&header, copy.data(), sizeof(header));
+        corrupt.second(copy.data(), header);
+        std::memcpy(copy.data(), &header, sizeof(header));
+        check(rejected(copy), "corrupt " + corrupt.first);
+    }
+}
+
+} // namespace
+
+int main() {
+    const auto values = sample_values();
+    check_round_trip(values);
+    check_truncated(values);
+    check_corrupt(values);
+
+    std::filesystem::remove(path);
+    return finish();
+}
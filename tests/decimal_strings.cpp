@@ -0,0 +1,130 @@
+// Checks add_decimal_strings and compare_decimal_strings against exact
+// reference arithmetic, on every kernel tier.
+//
+//     g++ -std=c++17 -O2 -pthread tests/decimal_strings.cpp -o decimal_strings
+//     ./decimal_strings
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+// up to 36 digits, so every value and every sum fits in an __int128
+string random_short_text() {
+    const auto kind = rng() % 4;
+    string text = rng() % 2 ? "-" : "";
+    text.append(rng() % 3, '0');
+
+    const auto n = int(rng() % 37);
+    for (int i = 0; i < n; ++i)
+        text += kind == 0 ? '9' : kind == 1 ? '0' : char('0' + rng() % 10);
+    if (text.empty() || text == "-")
+        text += '0';
+
+    return text;
+}
+
+__int128 to_int128(const string &text) {
+    __int128 value = 0;
+    for (auto c : text) {
+        if (c != '-')
+            value = value * 10 + (c - '0');
+    }
+
+    return text[0] == '-' ? -value : value;
+}
+
+string to_text(__int128 value) {
+    if (value == 0)
+        return "0";
+
+    const bool negative = value < 0;
+    string digits;
+    for (; value; value /= 10) {
+        const auto digit = int(value % 10);
+        digits += char('0' + (digit < 0 ? -digit : digit));
+    }
+
+    return (negative ? "-" : "") + string(digits.rbegin(), digits.rend());
+}
+
+// long canonical text, with runs of nines and zeros for long carries
+string random_long_text() {
+    const auto n = 1 + int(rng() % 400);
+    const auto kind = rng() % 3;
+    string text(1, char('1' + rng() % 9));
+    for (int i = 1; i < n; ++i)
+        text += kind == 0 ? '9' : kind == 1 ? '0' : char('0' + rng() % 10);
+
+    return (rng() % 2 ? "-" : "") + text;
+}
+
+void check_short(const string &tier) {
+    string sum;
+    for (int i = 0; i < 20000; ++i) {
+        const auto lhs = random_short_text();
+        const auto rhs = random_short_text();
+        const auto l_value = to_int128(lhs);
+        const auto r_value = to_int128(rhs);
+
+        add_decimal_strings(lhs, rhs, sum);
+        check(sum == to_text(l_value + r_value),
+              tier + " add " + lhs + " " + rhs);
+
+        const auto order = compare_decimal_strings(lhs, rhs);
+        check(order == (l_value < r_value ? -1 : l_value > r_value),
+              tier + " compare " + lhs + " " + rhs);
+    }
+}
+
+void check_long(const string &tier) {
+    string sum;
+    for (int i = 0; i < 2000; ++i) {
+        const auto lhs = random_long_text();
+        const auto rhs = random_long_text();
+        const BigInteger l_value(lhs), r_value(rhs);
+
+        ostringstream expected;
+        expected << l_value + r_value;
+        add_decimal_strings(lhs, rhs, sum);
+        check(sum == expected.str(), tier + " add " + lhs + " " + rhs);
+
+        const auto order = compare_decimal_strings(lhs, rhs);
+        check(order == (l_value < r_value ? -1 : r_value < l_value),
+              tier + " compare " + lhs + " " + rhs);
+    }
+}
+
+void check_malformed() {
+    string sum;
+    for (const char *text : {"", "-", "+1", "1-", "12a4", "1 2", "--1",
+                             "123456789012345678901234567890x"}) {
+        bool threw = false;
+        try {
+            add_decimal_strings(text, "1", sum);
+        } catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        check(threw, string("malformed \"") + text + "\"");
+    }
+}
+
+} // namespace
+
+int main() {
+    check_malformed();
+
+    for_each_tier([](const string &tier) {
+        check_short(tier);
+        check_long(tier);
+    });
+
+    return finish();
+}
@@ -0,0 +1,137 @@
+// Checks that delta sequences round trip and that out-of-range blocks and
+// corrupt or truncated input throw instead of producing invalid values.
+//
+//     g++ -std=c++17 -O2 -pthread tests/delta.cpp -o delta && ./delta
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+vector<BigInteger> sample_values(int count) {
+    vector<BigInteger> values;
+    for (int i = 0; i < count; ++i) {
+        auto digits = random_digits(1 + int(rng() % 30), int(rng() % 3));
+        digits.back() = char('1' + rng() % 9);
+        const string sign = rng() % 4 ? "" : "-";
+        values.emplace_back(sign + string(digits.rbegin(), digits.rend()));
+    }
+    values.emplace_back(0);
+
+    return values;
+}
+
+vector<uint8_t> encode(const vector<BigInteger> &values, size_t block_size) {
+    BigIntegerDeltaEncoder encoder(block_size);
+    for (const auto &value : values)
+        encoder.append(value);
+
+    return encoder.encode();
+}
+
+// true when decoding throws runtime_error rather than returning values
+bool rejected(const vector<uint8_t> &bytes) {
+    try {
+        BigIntegerDeltaDecoder decoder(bytes.data(), bytes.size());
+        decoder.decode();
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+
+    return false;
+}
+
+void check_round_trip() {
+    auto values = sample_values(200);
+    for (int sorted = 0; sorted < 2; ++sorted) {
+        if (sorted)
+            std::sort(values.begin(), values.end());
+
+        const auto bytes = encode(values, 16);
+        BigIntegerDeltaDecoder decoder(bytes.data(), bytes.size());
+        const auto decoded = decoder.decode();
+
+        check(decoded.size() == values.size(), "round trip size");
+        for (size_t i = 0; i < values.size(); ++i) {
+            check(BigInteger(decoded[i]) == values[i], "round trip value");
+            check(decoder[i] == values[i], "random access value");
+        }
+    }
+}
+
+void check_ranges() {
+    const auto bytes = encode(sample_values(5), 4);
+    BigIntegerDeltaDecoder decoder(bytes.data(), bytes.size());
+    check(decoder.block_count() == 2, "block count");
+
+    for (const size_t block : {size_t(2), size_t(7), ~size_t(0)}) {
+        bool threw = false;
+        try {
+            BigIntegerVector out;
+            decoder.decode_block(block, out);
+        } catch (const std::out_of_range &) {
+            threw = true;
+        }
+        check(threw, "decode_block " + to_string(block) + " out of range");
+    }
+
+    bool threw = false;
+    try {
+        decoder[decoder.size()];
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    check(threw, "operator[] out of range");
+}
+
+void check_truncated() {
+    const auto bytes = encode(sample_values(40), 8);
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        check(rejected(vector<uint8_t>(bytes.begin(), bytes.begin() + size)),
+              "truncated to " + to_string(size));
+    }
+}
+
+// one value in one block: count, block size, an 8-byte index entry, then
+// the raw value's tag and its digits two per byte
+vector<uint8_t> single_raw(uint64_t tag, const vector<uint8_t> &digits) {
+    vector<uint8_t> bytes;
+    detail::put_varint(bytes, 1);
+    detail::put_varint(bytes, 1);
+    bytes.insert(bytes.end(), 8, 0);
+    detail::put_varint(bytes, tag);
+    bytes.insert(bytes.end(), digits.begin(), digits.end());
+
+    return bytes;
+}
+
+void check_corrupt() {
+    // 12345, least significant digit first: 5 4, 3 2, 1
+    const uint64_t tag = 5 << 2 | 1;
+    check(!rejected(single_raw(tag, {0x45, 0x23, 0x01})), "valid raw value");
+
+    check(rejected(single_raw(tag, {0x4a, 0x23, 0x01})), "nibble above 9");
+    check(rejected(single_raw(tag, {0x45, 0x23, 0x00})), "leading zero");
+    check(rejected(single_raw(2 | 1, {})), "negative zero");
+    check(rejected(single_raw(uint64_t(1) << 40 << 2 | 1, {0x45})),
+          "digit count above int");
+}
+
+} // namespace
+
+int main() {
+    check_round_trip();
+    check_ranges();
+    check_truncated();
+    check_corrupt();
+
+    return finish();
+}
@@ -0,0 +1,186 @@
+// Checks that every kernel tier gives the same digits as the scalar one.
+//
+//     g++ -std=c++17 -O2 -pthread tests/kernels.cpp -o kernels && ./kernels
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+void check_digits_n(const detail::Kernels &kernels) {
+    const string tier = kernels.tier;
+
+    for (int n = 0; n <= 300; ++n) {
+        for (int kind = 0; kind < 9; ++kind) {
+            // an offset makes the vector loads unaligned
+            const auto offset = int(rng() % 8);
+            const auto a = random_digits(n + offset, kind / 3);
+            const auto b = random_digits(n + offset, kind % 3);
+            const auto carry = int(rng() % 2);
+
+            string expected(n, ' '), got(n, ' ');
+            auto want = detail::add_n_scalar(&expected[0], a.data() + offset,
+                                             b.data() + offset, n, carry);
+            auto have = kernels.add_n(&got[0], a.data() + offset,
+                                      b.data() + offset, n, carry);
+            check(want == have && expected == got,
+                  tier + " add_n, n = " + to_string(n));
+
+            want = detail::sub_n_scalar(&expected[0], a.data() + offset,
+                                        b.data() + offset, n, carry);
+            have = kernels.sub_n(&got[0], a.data() + offset, b.data() + offset,
+                                 n, carry);
+            check(want == have && expected == got,
+                  tier + " sub_n, n = " + to_string(n));
+        }
+    }
+}
+
+void check_addmul_1(const detail::Kernels &kernels) {
+    const string tier = kernels.tier;
+
+    for (int n = 0; n <= 100; ++n) {
+        for (int kind = 0; kind < 3; ++kind) {
+            // the largest limbs, on columns already holding up to
+            // LIMB_ROWS - 1 products
+            const uint32_t top = detail::LIMB_BASE - 1;
+            const auto full = uint64_t(top) * top * (detail::LIMB_ROWS - 1);
+            vector<uint32_t> a(n);
+            for (auto &limb : a)
+                limb = kind == 1 ? top : uint32_t(rng() % detail::LIMB_BASE);
+            const auto b =
+                kind == 1 ? top : uint32_t(rng() % detail::LIMB_BASE);
+
+            vector<uint64_t> expected(n);
+            for (auto &col : expected)
+                col = kind == 2 ? 0 : rng() % full;
+            auto got = expected;
+
+            detail::addmul_1_scalar(expected.data(), a.data(), n, b);
+            kernels.addmul_1(got.data(), a.data(), n, b);
+            check(expected == got, tier + " addmul_1, n = " + to_string(n));
+        }
+    }
+}
+
+// schoolbook on the text, independent of the library's kernels
+string reference_product(const BigInteger &lhs, const BigInteger &rhs) {
+    ostringstream l_out, r_out;
+    l_out << lhs;
+    r_out << rhs;
+    auto l_text = l_out.str(), r_text = r_out.str();
+
+    const bool negative = (l_text[0] == '-') != (r_text[0] == '-');
+    if (l_text[0] == '-')
+        l_text.erase(0, 1);
+    if (r_text[0] == '-')
+        r_text.erase(0, 1);
+
+    vector<int> cols(l_text.size() + r_text.size());
+    for (size_t i = 0; i < l_text.size(); ++i) {
+        for (size_t j = 0; j < r_text.size(); ++j)
+            cols[i + j + 1] += (l_text[i] - '0') * (r_text[j] - '0');
+    }
+    for (auto k = cols.size() - 1; k > 0; --k) {
+        cols[k - 1] += cols[k] / 10;
+        cols[k] %= 10;
+    }
+
+    string res;
+    for (auto col : cols) {
+        if (!res.empty() || col)
+            res += char('0' + col);
+    }
+    if (res.empty())
+        return "0";
+
+    return negative ? "-" + res : res;
+}
+
+void check_products(const vector<BigInteger> &operands) {
+    for (size_t i = 0; i + 1 < operands.size(); i += 7) {
+        ostringstream out;
+        out << operands[i] * operands[i + 1];
+        check(out.str() == reference_product(operands[i], operands[i + 1]),
+              "product " + to_string(i));
+    }
+}
+
+void check_reverse(const detail::Kernels &kernels) {
+    const string tier = kernels.tier;
+
+    for (int n = 0; n <= 300; ++n) {
+        const auto offset = int(rng() % 8);
+        const auto a = random_digits(n + offset, 0);
+
+        string expected(n, ' '), got(n, ' ');
+        detail::reverse_scalar(&expected[0], a.data() + offset, n);
+        kernels.reverse(&got[0], a.data() + offset, n);
+        check(expected == got, tier + " reverse, n = " + to_string(n));
+    }
+}
+
+// decimal text for the whole-operator checks, with long runs of nines and
+// zeros
+vector<string> random_texts(int count) {
+    vector<string> texts;
+    for (int i = 0; i < count; ++i) {
+        auto digits = random_digits(1 + int(rng() % 400), int(rng() % 3));
+        digits.back() = char('1' + rng() % 9);
+        const string sign = rng() % 2 ? "-" : "";
+        texts.push_back(sign + string(digits.rbegin(), digits.rend()));
+    }
+
+    return texts;
+}
+
+// parsing and formatting both go through the reverse kernel
+void check_text(const vector<string> &texts, const string &tier) {
+    for (const auto &text : texts) {
+        ostringstream out;
+        out << BigInteger(text);
+        check(out.str() == text, tier + " text round trip");
+    }
+}
+
+// everything the active tier computes for neighbouring operands, as text
+vector<string> operator_results(const vector<BigInteger> &operands) {
+    vector<string> results;
+    for (size_t i = 0; i + 1 < operands.size(); ++i) {
+        const auto &a = operands[i];
+        const auto &b = operands[i + 1];
+
+        ostringstream out;
+        out << a + b << ' ' << a - b << ' ' << a * b;
+        results.push_back(out.str());
+    }
+
+    return results;
+}
+
+} // namespace
+
+int main() {
+    const auto texts = random_texts(2000);
+    const vector<BigInteger> operands(texts.begin(), texts.end());
+    set_kernel_tier("scalar");
+    const auto expected = operator_results(operands);
+    check_products(operands);
+
+    for_each_tier([&](const string &tier) {
+        check_digits_n(detail::kernels());
+        check_addmul_1(detail::kernels());
+        check_reverse(detail::kernels());
+        check_text(texts, tier);
+        check(operator_results(operands) == expected, tier + " operators");
+    });
+
+    return finish();
+}
@@ -0,0 +1,74 @@
+// Checks sort_bigints against std::sort, including long shared prefixes that
+// once overflowed the stack and inputs large enough to use worker threads.
+//
+//     g++ -std=c++17 -O2 -pthread tests/sort.cpp -o sort && ./sort
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+void check_sorted(vector<BigInteger> values, const string &what) {
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+    sort_bigints(values);
+    check(values == expected, what);
+}
+
+BigInteger random_value(int digits, bool negative) {
+    auto text = random_digits(digits, 0);
+    text[0] = char('1' + rng() % 9);
+    return BigInteger((negative ? "-" : "") + text);
+}
+
+void check_small() {
+    check_sorted({}, "empty");
+    check_sorted({BigInteger(5)}, "one value");
+    check_sorted({BigInteger(3), BigInteger(-3), BigInteger(0), BigInteger(-30),
+                  BigInteger(30)},
+                 "signs and lengths");
+}
+
+void check_long_prefixes() {
+    // each shared leading digit used to cost a level of recursion
+    check_sorted(vector<BigInteger>(40, BigInteger(string(200000, '7'))),
+                 "equal long values");
+
+    const string prefix(100000, '4');
+    vector<BigInteger> values;
+    for (int i = 0; i < 100; ++i) {
+        const auto tail = random_digits(5, 0);
+        values.emplace_back((i % 2 ? "-" : "") + prefix + tail);
+    }
+    check_sorted(values, "deep shared prefix");
+}
+
+void check_large() {
+    // same-length buckets above the parallel cutoff, of both signs
+    vector<BigInteger> values;
+    for (int i = 0; i < 300000; ++i)
+        values.push_back(random_value(20 + int(rng() % 3), rng() % 3 == 0));
+    check_sorted(values, "large mixed input");
+
+    values.clear();
+    for (int i = 0; i < 200000; ++i)
+        values.push_back(random_value(12, true));
+    check_sorted(values, "large negative input");
+}
+
+} // namespace
+
+int main() {
+    check_small();
+    check_long_prefixes();
+    check_large();
+
+    return finish();
+}
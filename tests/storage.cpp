@@ -0,0 +1,110 @@
+// Checks digit storage: shared buffers, arenas and moved-from values.
+//
+//     g++ -std=c++17 -O2 -pthread tests/storage.cpp -o storage && ./storage
+//
+// Build with -fsanitize=address as well; a buffer outliving its arena shows
+// up as a use after free.
+
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+string text(const BigInteger &value) {
+    ostringstream out;
+    out << value;
+    return out.str();
+}
+
+void check_shared_copies() {
+    const string digits(300, '8');
+    BigInteger value(digits);
+    value.share();
+
+    BigInteger copy(value);
+    BigInteger assigned;
+    assigned = value;
+    check(copy.is_shared() && assigned.is_shared(), "copies share a buffer");
+
+    copy += 1;
+    check(!copy.is_shared() && text(value) == digits,
+          "a write unshares the copy");
+}
+
+// a value shared inside an arena is copied, not shared, by values outside
+void check_arena_shared() {
+    const string digits(300, '5');
+    BigInteger copied, assigned, moved;
+    {
+        ArenaScope scope;
+        BigInteger inner(digits);
+        inner.share();
+
+        BigInteger inner_copy(inner);
+        check(inner_copy.is_shared(), "copies inside an arena share");
+
+        assigned = inner;
+        moved = std::move(inner_copy);
+        copied = BigInteger(BigIntegerView(inner));
+    }
+
+    // the arena is gone; these read freed memory if they still share it
+    check(!assigned.is_shared() && text(assigned) == digits,
+          "copy assignment out of an arena");
+    check(!moved.is_shared() && text(moved) == digits,
+          "move assignment out of an arena");
+    check(text(copied) == digits, "view copy out of an arena");
+
+    // copy construction outside a scope allocates from the default resource
+    BigInteger outer(digits);
+    outer.share();
+    {
+        ArenaScope scope;
+        BigInteger inner(outer);
+        check(!inner.is_shared() && text(inner) == digits,
+              "copy into an arena");
+    }
+    check(text(outer) == digits, "source outlives the arena");
+}
+
+// a moved-from value is a canonical zero, hash and fingerprint included
+void check_moved_from() {
+    const BigInteger zero(0);
+    for (int shared = 0; shared < 2; ++shared) {
+        BigInteger source("-" + string(100, '3'));
+        source.enable_fingerprint();
+        source.hash();
+        if (shared)
+            source.share();
+
+        BigInteger moved(std::move(source));
+        check(source == zero && text(source) == "0", "move source is zero");
+        check(source.hash() == zero.hash() &&
+                  source.fingerprint() == zero.fingerprint(),
+              "move source caches");
+
+        BigInteger assigned;
+        assigned = std::move(moved);
+        check(moved == zero && moved.hash() == zero.hash() &&
+                  moved.fingerprint() == zero.fingerprint(),
+              "move assignment source");
+        check(text(assigned) == "-" + string(100, '3'), "moved value");
+    }
+}
+
+} // namespace
+
+int main() {
+    check_shared_copies();
+    check_arena_shared();
+    check_moved_from();
+
+    return finish();
+}
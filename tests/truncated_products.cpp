@@ -0,0 +1,219 @@
+// Checks mullo, mulhi, mul_mod_pow10, mul_mod_pow2 and mulmid against the
+// full product, on operands with long runs of nines and zeros.
+//
+//     g++ -std=c++17 -O2 -pthread tests/truncated_products.cpp
+//         -o truncated_products
+//     ./truncated_products
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+
+using namespace std;
+using namespace gh;
+using namespace tests;
+
+namespace {
+
+string text(const BigInteger &value) {
+    ostringstream out;
+    out << value;
+    return out.str();
+}
+
+// most significant first, built from runs of nines, runs of zeros and
+// random digits; products of such operands carry across long stretches
+string random_operand(int max_digits) {
+    const auto n = 1 + int(rng() % max_digits);
+    string digits(1, char('1' + rng() % 9));
+    while (int(digits.size()) < n) {
+        const auto run = 1 + int(rng() % 60);
+        switch (rng() % 3) {
+        case 0:
+            digits.append(run, '9');
+            break;
+        case 1:
+            digits.append(run, '0');
+            break;
+        default:
+            digits += random_digits(run, 0);
+        }
+    }
+    digits.resize(n);
+
+    return (rng() % 2 ? "-" : "") + digits;
+}
+
+// the magnitude's text and the sign of the product
+struct Product {
+    string digits;
+    bool negative;
+};
+
+Product full_product(const BigInteger &lhs, const BigInteger &rhs) {
+    auto digits = text(lhs * rhs);
+    const bool negative = digits[0] == '-';
+    if (negative)
+        digits.erase(0, 1);
+
+    return {digits == "0" ? "" : digits, negative};
+}
+
+// normalized text of a sign and a most-significant-first digit string
+string signed_text(bool negative, string digits) {
+    const auto first = digits.find_first_not_of('0');
+    if (first == string::npos)
+        return "0";
+
+    return (negative ? "-" : "") + digits.substr(first);
+}
+
+// bits of the product, by repeated halving of its magnitude
+BigInteger mod_pow2(const BigInteger &value, int k) {
+    BigInteger power(1), quotient(value);
+    for (int i = 0; i < k; ++i) {
+        power *= 2;
+        quotient /= 2;
+    }
+
+    return value - quotient * power;
+}
+
+void check_products(int rounds) {
+    for (int round = 0; round < rounds; ++round) {
+        const BigInteger lhs(random_operand(120));
+        const BigInteger rhs(random_operand(120));
+        const auto product = full_product(lhs, rhs);
+        const int size = product.digits.size();
+        const auto n = int(rng() % (size + 20));
+        const auto what = " of " + text(lhs) + " * " + text(rhs) +
+                          ", n = " + to_string(n);
+
+        const auto low = n >= size ? product.digits
+                                   : product.digits.substr(size - n);
+        check(text(BigInteger::mullo(lhs, rhs, n)) ==
+                  signed_text(product.negative, low),
+              "mullo" + what);
+
+        BigInteger modded(lhs);
+        modded.mul_mod_pow10(rhs, n);
+        check(text(modded) == signed_text(product.negative, low),
+              "mul_mod_pow10" + what);
+
+        const auto high = n >= size ? "" : product.digits.substr(0, size - n);
+        check(text(BigInteger::mulhi(lhs, rhs, n)) ==
+                  signed_text(product.negative, high),
+              "mulhi" + what);
+
+        const auto bits = int(rng() % 400);
+        BigInteger reduced(lhs);
+        reduced.mul_mod_pow2(rhs, bits);
+        check(reduced == mod_pow2(lhs * rhs, bits),
+              "mul_mod_pow2" + what + ", bits = " + to_string(bits));
+    }
+}
+
+// (10^a - 1)(10^b - 1) = 10^(a + b) - 10^a - 10^b + 1 is mostly nines, so
+// the skipped columns below mulhi's window may carry into it
+void check_nines() {
+    for (int a = 20; a <= 120; a += 7) {
+        for (int b = 20; b <= 120; b += 11) {
+            const BigInteger lhs(string(a, '9'));
+            const BigInteger rhs(string(b, '9'));
+            const auto product = full_product(lhs, rhs);
+            const int size = product.digits.size();
+
+            for (int n = 0; n <= size; n += 1 + n / 8) {
+                check(text(BigInteger::mulhi(lhs, rhs, n)) ==
+                          signed_text(false, product.digits.substr(0, size - n)),
+                      "mulhi of nines, a = " + to_string(a) +
+                          ", b = " + to_string(b) + ", n = " + to_string(n));
+            }
+        }
+    }
+}
+
+// mulmid drops the carry out of the skipped columns, so modulo 10^(to - from)
+// it may fall short of the exact digits, by at most 10^18; with nothing
+// skipped it is exact
+void check_middle(int rounds) {
+    const BigInteger slack("1" + string(18, '0'));
+    for (int round = 0; round < rounds; ++round) {
+        const BigInteger lhs(random_operand(120));
+        const BigInteger rhs(random_operand(120));
+        const auto product = full_product(lhs, rhs);
+        const int size = product.digits.size();
+        const auto from = rng() % 4 ? int(rng() % (size + 10)) : 0;
+        const auto to = from + int(rng() % (size + 10 - from));
+        const auto what = " of " + text(lhs) + " * " + text(rhs) +
+                          ", digits " + to_string(from) + ".." +
+                          to_string(to);
+
+        string exact;
+        if (from < size) {
+            const auto high = std::min(to, size);
+            exact = product.digits.substr(size - high, high - from);
+        }
+
+        const auto middle = BigInteger::mulmid(lhs, rhs, from, to);
+        if (from == 0) {
+            check(text(middle) == signed_text(product.negative, exact),
+                  "mulmid" + what);
+            continue;
+        }
+
+        auto magnitude = text(middle);
+        const bool negative = magnitude[0] == '-';
+        if (negative)
+            magnitude.erase(0, 1);
+        check(negative == (product.negative && magnitude != "0"),
+              "mulmid sign" + what);
+        check(int(magnitude.size()) <= std::max(1, to - from),
+              "mulmid length" + what);
+
+        // both magnitudes are below 10^(to - from); wrap the difference
+        auto shortfall = BigInteger(signed_text(false, exact)) -
+                         BigInteger(magnitude);
+        if (shortfall < BigInteger(0))
+            shortfall += BigInteger("1" + string(to - from, '0'));
+        check(shortfall <= slack, "mulmid shortfall" + what);
+    }
+}
+
+void check_invalid() {
+    const BigInteger value(12345);
+    for (int which = 0; which < 6; ++which) {
+        bool threw = false;
+        try {
+            BigInteger copy(value);
+            if (which == 0)
+                BigInteger::mullo(value, value, -1);
+            else if (which == 1)
+                BigInteger::mulhi(value, value, -1);
+            else if (which == 2)
+                copy.mul_mod_pow10(value, -1);
+            else if (which == 3)
+                copy.mul_mod_pow2(value, -1);
+            else if (which == 4)
+                BigInteger::mulmid(value, value, -1, 3);
+            else
+                BigInteger::mulmid(value, value, 5, 4);
+        } catch (const std::invalid_argument &) {
+            threw = true;
+        }
+        check(threw, "invalid count " + to_string(which));
+    }
+}
+
+} // namespace
+
+int main() {
+    check_products(3000);
+    check_nines();
+    check_middle(3000);
+    check_invalid();
+
+    return finish();
+}